@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Prints time to work out upgradable packages locally at 10..10000
+// packages, orderings are checked by deb-version-test:
+//   ./benchmark-deb-version [--rounds n]
+
+#include <algorithm>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+#include "services/package/deb_version.h"
+
+namespace {
+
+const int kPackageCounts[] = { 10, 100, 1000, 10000 };
+
+// Versions shaped like those of a desktop install.
+QString FakeVersion(int index, int bump) {
+  switch (index % 4) {
+    case 0:
+      return QString("%1.%2.%3-1").arg(index % 7).arg(index % 13).arg(bump);
+    case 1:
+      return QString("1:%1.%2+dfsg-%3deepin1").arg(index % 5).arg(index % 11)
+          .arg(bump);
+    case 2:
+      return QString("%1.%2~rc%3").arg(index % 9).arg(index % 3).arg(bump);
+    default:
+      return QString("%1.0.%2+b%3").arg(index % 17).arg(index).arg(bump);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Benchmark of Debian version comparison");
+  parser.addHelpOption();
+  parser.addOptions({
+    { "rounds", "Rounds at each package count.", "n", "100" },
+  });
+  parser.process(app);
+  const int rounds = qMax(1, parser.value("rounds").toInt());
+
+  printf("%-8s %12s %12s %10s\n", "pkgs", "total(us)", "per-pkg(ns)",
+         "upgradable");
+  for (int packages : kPackageCounts) {
+    QStringList local;
+    QStringList remote;
+    for (int i = 0; i < packages; ++i) {
+      local.append(FakeVersion(i, 1));
+      remote.append(FakeVersion(i, i % 3));
+    }
+
+    QVector<qint64> samples;
+    int upgradable = 0;
+    for (int round = 0; round < rounds; ++round) {
+      QElapsedTimer timer;
+      timer.start();
+      upgradable = 0;
+      for (int i = 0; i < packages; ++i) {
+        if (dstore::IsDebUpgradable(local.at(i), remote.at(i))) {
+          upgradable++;
+        }
+      }
+      samples.append(timer.nsecsElapsed());
+    }
+    std::sort(samples.begin(), samples.end());
+    const qint64 median = samples.at(samples.size() / 2);
+    printf("%-8d %12.1f %12.1f %10d\n", packages, median / 1000.0,
+           double(median) / packages, upgradable);
+  }
+
+  return 0;
+}
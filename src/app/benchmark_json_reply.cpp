@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compares the two ways of writing a deferred installedPackages() reply
+// into a web channel response, at 100/1000/10000 packages:
+// * variant: QJsonValue::fromVariant() + indented QJsonDocument::toJson()
+// * direct: ToCompactJson() spliced into response header
+//   ./benchmark-json-reply [--rounds n]
+
+#include <algorithm>
+#include <functional>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVector>
+
+#include "base/json_writer.h"
+
+namespace {
+
+const int kPackageCounts[] = { 100, 1000, 10000 };
+
+// Same shape as reply of StoreDaemonManager::installedPackages().
+QVariantMap FakeInstalledReply(int count) {
+  QVariantList packages;
+  for (int i = 0; i < count; ++i) {
+    const QString name = QString("fake-package-%1").arg(i);
+    packages.append(QVariantMap {
+      { "packageURI", "dpk://deb/" + name },
+      { "packageName", name + ":amd64" },
+      { "appName", name },
+      { "localVersion", QString("1.%1.0-1").arg(i) },
+      { "remoteVersion", "" },
+      { "installedTime", qlonglong(1544583742 + i) },
+      { "upgradable", false },
+      { "size", qlonglong(1024 * i) },
+      { "downloadSize", qlonglong(0) },
+      { "localName", "" },
+      { "allLocalName", QVariantMap {
+        { "en_US", name },
+        { "zh_CN", QString::fromUtf8("\xe8\xbd\xaf\xe4\xbb\xb6 %1").arg(i) },
+      } },
+    });
+  }
+  return QVariantMap {
+    { "ok", true },
+    { "errorName", "" },
+    { "errorMsg", "" },
+    { "version", qlonglong(1) },
+    { "result", packages },
+  };
+}
+
+QJsonObject ResponseHeader() {
+  return QJsonObject {
+    { "type", 10 },
+    { "id", 42 },
+  };
+}
+
+QString VariantPath(const QVariantMap& reply) {
+  QJsonObject msg = ResponseHeader();
+  msg.insert("data", QJsonValue::fromVariant(reply));
+  return QString(QJsonDocument(msg).toJson());
+}
+
+QString DirectPath(const QVariantMap& reply) {
+  const QByteArray json = dstore::ToCompactJson(reply);
+  QByteArray frame = QJsonDocument(ResponseHeader())
+      .toJson(QJsonDocument::Compact);
+  frame.chop(1);
+  frame.append(",\"data\":");
+  frame.append(json);
+  frame.append('}');
+  return QString::fromUtf8(frame);
+}
+
+// Returns median time in microseconds, |size| receives bytes of output.
+double Measure(std::function<QString()> serialize, int rounds, int& size) {
+  QVector<qint64> samples;
+  for (int i = 0; i < rounds; ++i) {
+    QElapsedTimer timer;
+    timer.start();
+    const QString msg = serialize();
+    samples.append(timer.nsecsElapsed());
+    size = msg.toUtf8().size();
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples.at(samples.size() / 2) / 1000.0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Benchmark of web channel reply encoding");
+  parser.addHelpOption();
+  parser.addOptions({
+    { "rounds", "Rounds at each package count.", "n", "20" },
+  });
+  parser.process(app);
+  const int rounds = qMax(1, parser.value("rounds").toInt());
+
+  printf("%-8s %-8s %12s %12s\n", "pkgs", "path", "median(us)", "bytes");
+  for (int packages : kPackageCounts) {
+    const QVariantMap reply = FakeInstalledReply(packages);
+
+    // Both paths must carry the same data.
+    const QJsonDocument variant_doc =
+        QJsonDocument::fromJson(VariantPath(reply).toUtf8());
+    const QJsonDocument direct_doc =
+        QJsonDocument::fromJson(DirectPath(reply).toUtf8());
+    if (variant_doc != direct_doc) {
+      printf("MISMATCH at %d packages\n", packages);
+      return 1;
+    }
+
+    int size = 0;
+    double elapsed = Measure([&reply]() { return VariantPath(reply); },
+                             rounds, size);
+    printf("%-8d %-8s %12.1f %12d\n", packages, "variant", elapsed, size);
+    elapsed = Measure([&reply]() { return DirectPath(reply); }, rounds, size);
+    printf("%-8d %-8s %12.1f %12d\n", packages, "direct", elapsed, size);
+    fflush(stdout);
+  }
+
+  return 0;
+}
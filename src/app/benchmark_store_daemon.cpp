@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Drives StoreDaemonManager through fake-lastore-daemon and prints
+// p50/p99 latency of requests at 10/100/1000 packages.
+// Run it in a private session bus, as fake daemon takes the name of
+// deepin-appstore-daemon:
+//   dbus-run-session ./benchmark-store-daemon [--latency ms] [--rounds n]
+
+#include <algorithm>
+#include <functional>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtDBus/QtDBus>
+
+#include "dbus/dbus_consts.h"
+#include "services/store_daemon_manager.h"
+
+namespace {
+
+const int kPackageCounts[] = { 10, 100, 1000 };
+const char kFakeDaemon[] = "fake-lastore-daemon";
+
+typedef std::function<void(std::function<void()>)> Request;
+
+// Start fake daemon and wait until it owns the service name.
+QProcess* StartFakeDaemon(int packages, int latency) {
+  QProcess* process = new QProcess();
+  process->setProcessChannelMode(QProcess::ForwardedChannels);
+  process->start(QDir(QCoreApplication::applicationDirPath())
+                     .absoluteFilePath(kFakeDaemon),
+                 {
+                   "--packages", QString::number(packages),
+                   "--jobs", QString::number(packages),
+                   "--latency", QString::number(latency),
+                 });
+  QDBusConnectionInterface* bus = QDBusConnection::sessionBus().interface();
+  QElapsedTimer timer;
+  timer.start();
+  while (!bus->isServiceRegistered(dstore::kLastoreDebDbusService)) {
+    if (timer.elapsed() > 5000) {
+      qCritical() << "fake daemon does not start";
+      break;
+    }
+    QThread::msleep(10);
+  }
+  return process;
+}
+
+void StopFakeDaemon(QProcess* process) {
+  process->terminate();
+  process->waitForFinished();
+  delete process;
+}
+
+// Returns latency of each round in microseconds, sorted.
+QList<qint64> Measure(Request request, int rounds) {
+  QList<qint64> samples;
+  for (int i = 0; i < rounds; ++i) {
+    QEventLoop loop;
+    bool done = false;
+    QElapsedTimer timer;
+    timer.start();
+    request([&loop, &done]() {
+      done = true;
+      loop.quit();
+    });
+    // Callback might be called synchronously.
+    if (!done) {
+      loop.exec();
+    }
+    samples.append(timer.nsecsElapsed() / 1000);
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples;
+}
+
+double Percentile(const QList<qint64>& samples, int percent) {
+  if (samples.isEmpty()) {
+    return 0;
+  }
+  return samples.at((samples.length() - 1) * percent / 100) / 1000.0;
+}
+
+void Report(const char* name, int packages, const QList<qint64>& samples) {
+  printf("%-20s %6d %10.3f %10.3f\n", name, packages,
+         Percentile(samples, 50), Percentile(samples, 99));
+  fflush(stdout);
+}
+
+QVariantList FakeApps(int count) {
+  QVariantList apps;
+  for (int i = 0; i < count; ++i) {
+    const QString name = QString("fake-package-%1").arg(i);
+    apps.append(QVariantMap {
+      { "name", name },
+      { "localName", name },
+      { "packages", QVariantList { QVariantMap {
+        { "packageURI", "dpk://deb/" + name },
+      } } },
+    });
+  }
+  return apps;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Benchmark of StoreDaemonManager");
+  parser.addHelpOption();
+  parser.addOptions({
+    { "latency", "Delay of each reply of fake daemon in ms.", "ms", "0" },
+    { "rounds", "Rounds of each request.", "n", "50" },
+  });
+  parser.process(app);
+  const int latency = parser.value("latency").toInt();
+  const int rounds = parser.value("rounds").toInt();
+
+  // Keep installed package snapshot away from the real cache dir.
+  QTemporaryDir home;
+  qputenv("HOME", home.path().toLocal8Bit());
+
+  printf("%-20s %6s %10s %10s\n", "request", "pkgs", "p50(ms)", "p99(ms)");
+  for (int packages : kPackageCounts) {
+    QProcess* daemon = StartFakeDaemon(packages, latency);
+    {
+      dstore::StoreDaemonManager manager;
+      const QVariantList apps = FakeApps(packages);
+      QStringList jobs;
+      Measure([&](std::function<void()> done) {
+        manager.jobList([&jobs, done](const QVariantMap& reply) {
+          jobs = reply.value("result").toStringList();
+          done();
+        });
+      }, 1);
+
+      Report("query", packages, Measure([&](std::function<void()> done) {
+        manager.query(apps, [done](const QVariantMap&) { done(); });
+      }, rounds));
+
+      Report("queryDownloadSize", packages,
+             Measure([&](std::function<void()> done) {
+        manager.queryDownloadSize(apps, [done](const QVariantMap&) {
+          done();
+        });
+      }, rounds));
+
+      Report("installedPackages", packages,
+             Measure([&](std::function<void()> done) {
+        manager.installedPackages([done](const QVariantMap&) { done(); });
+      }, rounds));
+
+      Report("getJobsInfo", packages,
+             Measure([&](std::function<void()> done) {
+        manager.getJobsInfo(jobs, [done](const QVariantMap&) { done(); });
+      }, rounds));
+    }
+    StopFakeDaemon(daemon);
+  }
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Round trips of web channel calls through ChannelProxy, speaking the
+// qwebchannel.js protocol by hand, at 16/1024/65536 bytes of payload:
+// * ping: slot replies directly in web channel thread
+// * pingDeferred: slot replies from worker of StoreDaemonProxy
+// Traffic stats of transport are printed at the end.
+//   dbus-run-session ./benchmark-web-channel [--rounds n]
+
+#include <algorithm>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QWebChannel>
+
+#include "ui/channel/channel_proxy.h"
+#include "ui/channel/store_daemon_proxy.h"
+
+namespace {
+
+const int kPayloadSizes[] = { 16, 1024, 65536 };
+const char kObjectName[] = "storeDaemon";
+const int kChannelMessageInit = 3;
+
+// Plays the web page side of |proxy|.
+class FakePage : public QObject {
+ public:
+  explicit FakePage(dstore::ChannelProxy* proxy) : proxy_(proxy) {
+    connect(proxy, &dstore::ChannelProxy::message,
+            this, &FakePage::onMessage);
+  }
+
+  // Send |msg| and wait for response of it, returns its data.
+  QJsonValue call(QJsonObject msg) {
+    msg.insert("id", ++last_id_);
+    response_ = QJsonValue();
+    proxy_->send(QString::fromUtf8(
+        QJsonDocument(msg).toJson(QJsonDocument::Compact)));
+    if (!responded_) {
+      loop_.exec();
+    }
+    responded_ = false;
+    return response_;
+  }
+
+  int bytesReceived() const {
+    return bytes_received_;
+  }
+
+ private:
+  void onMessage(const QString& data) {
+    const QByteArray frame = data.toUtf8();
+    bytes_received_ += frame.size();
+    const QJsonDocument doc = QJsonDocument::fromJson(frame);
+    const QJsonArray messages = doc.isArray() ?
+        doc.array() : QJsonArray { doc.object() };
+    for (const QJsonValue& value : messages) {
+      const QJsonObject msg = value.toObject();
+      if (msg.value("type").toInt() == dstore::kChannelMessageResponse &&
+          msg.value("id").toInt() == last_id_) {
+        response_ = msg.value("data");
+        responded_ = true;
+        loop_.quit();
+      }
+    }
+  }
+
+  dstore::ChannelProxy* proxy_ = nullptr;
+  QEventLoop loop_;
+  QJsonValue response_;
+  bool responded_ = false;
+  int last_id_ = 0;
+  int bytes_received_ = 0;
+};
+
+// Returns index of |method| listed in init response of |object|.
+int MethodIndex(const QJsonValue& init, const QString& object,
+                const QString& method) {
+  const QJsonArray methods =
+      init.toObject().value(object).toObject().value("methods").toArray();
+  for (const QJsonValue& entry : methods) {
+    const QJsonArray pair = entry.toArray();
+    if (pair.at(0).toString() == method) {
+      return pair.at(1).toInt();
+    }
+  }
+  return -1;
+}
+
+double Percentile(const QList<qint64>& samples, int percent) {
+  if (samples.isEmpty()) {
+    return 0;
+  }
+  return samples.at((samples.length() - 1) * percent / 100) / 1000.0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Benchmark of web channel round trips");
+  parser.addHelpOption();
+  parser.addOptions({
+    { "rounds", "Rounds at each payload size.", "n", "200" },
+  });
+  parser.process(app);
+  const int rounds = qMax(1, parser.value("rounds").toInt());
+
+  // Same wiring as WebWindow::initProxy(), in one thread.
+  dstore::ChannelProxy channel_proxy(nullptr);
+  QWebChannel web_channel;
+  web_channel.connectTo(channel_proxy.transport);
+  dstore::StoreDaemonProxy store_daemon_proxy;
+  web_channel.registerObject(kObjectName, &store_daemon_proxy);
+  channel_proxy.transport->setObjects(web_channel.registeredObjects());
+  QObject::connect(&store_daemon_proxy,
+                   &dstore::StoreDaemonProxy::deferredReplyReady,
+                   channel_proxy.transport,
+                   &dstore::ChannelTransport::replyJson);
+
+  FakePage page(&channel_proxy);
+  const QJsonValue init = page.call({ { "type", kChannelMessageInit } });
+
+  printf("%-14s %8s %10s %10s %12s\n",
+         "method", "payload", "p50(ms)", "p99(ms)", "bytes/call");
+  for (const char* method : { "ping", "pingDeferred" }) {
+    const int index = MethodIndex(init, kObjectName, method);
+    if (index < 0) {
+      printf("%s is not found in init response\n", method);
+      return 1;
+    }
+    for (int size : kPayloadSizes) {
+      const QString payload(size, 'x');
+      const QJsonObject msg {
+        { "type", dstore::kChannelMessageInvokeMethod },
+        { "object", kObjectName },
+        { "method", index },
+        { "args", QJsonArray { payload } },
+      };
+
+      const int bytes_before = page.bytesReceived();
+      QList<qint64> samples;
+      for (int i = 0; i < rounds; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        const QJsonValue result = page.call(msg);
+        samples.append(timer.nsecsElapsed() / 1000);
+        if (result.toString() != payload) {
+          printf("MISMATCH in %s at %d bytes\n", method, size);
+          return 1;
+        }
+      }
+      std::sort(samples.begin(), samples.end());
+      printf("%-14s %8d %10.3f %10.3f %12d\n", method, size,
+             Percentile(samples, 50), Percentile(samples, 99),
+             (page.bytesReceived() - bytes_before) / rounds);
+      fflush(stdout);
+    }
+  }
+
+  printf("\n%s\n", qPrintable(channel_proxy.transport->dumpStats()));
+  return 0;
+}
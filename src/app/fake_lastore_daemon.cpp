@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Stand-in of deb backend of deepin-appstore-daemon on session bus.
+// It is used to benchmark and load test the native package path
+// without lastore, see benchmark_store_daemon.cpp.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QHash>
+#include <QTimer>
+#include <QtDBus/QtDBus>
+
+#include "dbus/dbus_consts.h"
+#include "dbus/dbus_variant/app_version.h"
+#include "dbus/dbus_variant/installed_app_info.h"
+#include "dbus/dbus_variant/installed_app_timestamp.h"
+
+namespace {
+
+const char kPropIface[] = "org.freedesktop.DBus.Properties";
+const char kDebIface[] = "com.deepin.AppStore.Backend.Deb";
+const char kJobIface[] = "com.deepin.AppStore.Backend.Deb.Job";
+const char kJobPathPrefix[] = "/com/deepin/AppStore/Backend/Job";
+
+struct Options {
+  // Milliseconds to wait before each method reply.
+  int latency = 0;
+  // Number of installed packages.
+  int packages = 100;
+  // Number of paused jobs created at startup.
+  int jobs = 0;
+  // Progress updates of running jobs per second.
+  int progress_rate = 10;
+  // Progress added in each update, 0.01 means 100 updates per job.
+  double progress_step = 0.01;
+};
+
+QString PackageName(int index) {
+  return QString("fake-package-%1").arg(index);
+}
+
+void EmitPropertiesChanged(const QString& path,
+                           const QString& iface,
+                           const QVariantMap& changed) {
+  QDBusMessage signal =
+      QDBusMessage::createSignal(path, kPropIface, "PropertiesChanged");
+  signal << iface << changed << QStringList();
+  QDBusConnection::sessionBus().send(signal);
+}
+
+class FakeJob : public QObject {
+  Q_OBJECT
+  Q_CLASSINFO("D-Bus Interface", "com.deepin.AppStore.Backend.Deb.Job")
+  Q_PROPERTY(bool Cancelable READ cancelable)
+  Q_PROPERTY(qlonglong CreateTime READ createTime)
+  Q_PROPERTY(QString Description READ description)
+  Q_PROPERTY(qlonglong DownloadSize READ downloadSize)
+  Q_PROPERTY(QString Id READ id)
+  Q_PROPERTY(QString Name READ name)
+  Q_PROPERTY(QVariantMap PackageStatus READ packageStatus)
+  Q_PROPERTY(QStringList Packages READ packages)
+  Q_PROPERTY(double Progress READ progress)
+  Q_PROPERTY(qlonglong Speed READ speed)
+  Q_PROPERTY(QString Status READ status)
+  Q_PROPERTY(QString Type READ type)
+
+ public:
+  FakeJob(const QString& id,
+          const QString& name,
+          const QString& type,
+          const QStringList& packages,
+          const Options& options,
+          QObject* parent)
+      : QObject(parent),
+        id_(id),
+        name_(name),
+        type_(type),
+        packages_(packages),
+        step_(options.progress_step),
+        create_time_(QDateTime::currentSecsSinceEpoch()),
+        timer_(new QTimer(this)) {
+    timer_->setInterval(1000 / qMax(options.progress_rate, 1));
+    connect(timer_, &QTimer::timeout, this, &FakeJob::advance);
+    if (packages.length() > 1) {
+      for (const QString& package : packages) {
+        package_status_.insert(package, status_);
+      }
+    }
+  }
+
+  QString path() const { return kJobPathPrefix + id_; }
+
+  bool cancelable() const { return true; }
+  qlonglong createTime() const { return create_time_; }
+  QString description() const { return QString(); }
+  qlonglong downloadSize() const { return packages_.length() * 1024 * 1024; }
+  QString id() const { return id_; }
+  QString name() const { return name_; }
+  QVariantMap packageStatus() const { return package_status_; }
+  QStringList packages() const { return packages_; }
+  double progress() const { return progress_; }
+  qlonglong speed() const { return timer_->isActive() ? 1024 * 1024 : 0; }
+  QString status() const { return status_; }
+  QString type() const { return type_; }
+
+ signals:
+  void finished(const QString& path);
+
+ public slots:
+  Q_SCRIPTABLE void Clean() {
+    timer_->stop();
+    emit this->finished(this->path());
+  }
+
+  Q_SCRIPTABLE void Pause() {
+    timer_->stop();
+    this->setStatus("paused");
+  }
+
+  Q_SCRIPTABLE void Start() {
+    timer_->start();
+    this->setStatus("running");
+  }
+
+ private:
+  void advance() {
+    progress_ = qMin(progress_ + step_, 1.0);
+    QVariantMap changed {
+      { "Progress", progress_ },
+      { "Speed", this->speed() },
+    };
+    EmitPropertiesChanged(this->path(), kJobIface, changed);
+
+    if (progress_ >= 1.0) {
+      timer_->stop();
+      this->setStatus("succeed");
+      emit this->finished(this->path());
+    }
+  }
+
+  void setStatus(const QString& status) {
+    status_ = status;
+    QVariantMap changed {
+      { "Status", status_ },
+      { "Speed", this->speed() },
+    };
+    if (!package_status_.isEmpty()) {
+      for (const QString& package : package_status_.keys()) {
+        package_status_.insert(package, status_);
+      }
+      changed.insert("PackageStatus", package_status_);
+    }
+    EmitPropertiesChanged(this->path(), kJobIface, changed);
+  }
+
+  QString id_;
+  QString name_;
+  QString type_;
+  QStringList packages_;
+  QString status_ = "ready";
+  QVariantMap package_status_;
+  double progress_ = 0;
+  double step_;
+  qlonglong create_time_;
+  QTimer* timer_;
+};
+
+class FakeDebBackend : public QObject, protected QDBusContext {
+  Q_OBJECT
+  Q_CLASSINFO("D-Bus Interface", "com.deepin.AppStore.Backend.Deb")
+  Q_PROPERTY(QList<QDBusObjectPath> JobList READ jobList)
+
+ public:
+  FakeDebBackend(const Options& options, QObject* parent)
+      : QObject(parent), options_(options) {
+    for (int i = 0; i < options_.jobs; ++i) {
+      FakeJob* job = this->addJob("install", { PackageName(i) });
+      job->Pause();
+    }
+  }
+
+  QList<QDBusObjectPath> jobList() const {
+    QList<QDBusObjectPath> paths;
+    for (FakeJob* job : jobs_) {
+      paths.append(QDBusObjectPath(job->path()));
+    }
+    return paths;
+  }
+
+ public slots:
+  Q_SCRIPTABLE void CleanArchives() {
+    this->reply(QVariant());
+  }
+
+  Q_SCRIPTABLE QDBusObjectPath FixError(const QString& errType) {
+    return this->reply(this->startJob("fix_error", { errType }));
+  }
+
+  Q_SCRIPTABLE QDBusObjectPath Install(const QString& localName,
+                                       const QString& id) {
+    Q_UNUSED(localName);
+    return this->reply(this->startJob("install", { id }));
+  }
+
+  Q_SCRIPTABLE QDBusObjectPath InstallPackages(const QString& localName,
+                                               const QStringList& idList) {
+    Q_UNUSED(localName);
+    return this->reply(this->startJob("install", idList));
+  }
+
+  Q_SCRIPTABLE InstalledAppInfoList ListInstalled() {
+    InstalledAppInfoList list;
+    for (int i = 0; i < options_.packages; ++i) {
+      InstalledAppInfo info;
+      info.packageName = PackageName(i) + ":amd64";
+      info.appName = PackageName(i);
+      info.version = "1.0.0";
+      info.size = 1024 * 1024;
+      info.installationTime = 1500000000 + i;
+      info.localeNames.insert("en_US", PackageName(i));
+      info.localeNames.insert("zh_CN", PackageName(i));
+      list.append(info);
+    }
+    return this->reply(list);
+  }
+
+  Q_SCRIPTABLE qlonglong QueryDownloadSize(const QString& id) {
+    return this->reply(qlonglong(1024 * (id.length() + 1)));
+  }
+
+  Q_SCRIPTABLE InstalledAppTimestampList QueryInstallationTime(
+      const QStringList& idList) {
+    InstalledAppTimestampList list;
+    for (const QString& id : idList) {
+      InstalledAppTimestamp timestamp;
+      timestamp.pkg_name = id;
+      timestamp.timestamp = 1500000000;
+      list.append(timestamp);
+    }
+    return this->reply(list);
+  }
+
+  Q_SCRIPTABLE AppVersionList QueryVersion(const QStringList& idList) {
+    AppVersionList list;
+    for (const QString& id : idList) {
+      AppVersion version;
+      version.pkg_name = id + ":amd64";
+      version.installed_version = "1.0.0";
+      version.remote_version = "1.0.1";
+      version.upgradable = true;
+      list.append(version);
+    }
+    return this->reply(list);
+  }
+
+  Q_SCRIPTABLE QDBusObjectPath Remove(const QString& localName,
+                                      const QString& id) {
+    Q_UNUSED(localName);
+    return this->reply(this->startJob("remove", { id }));
+  }
+
+  Q_SCRIPTABLE QDBusObjectPath RemovePackages(const QString& localName,
+                                              const QStringList& idList) {
+    Q_UNUSED(localName);
+    return this->reply(this->startJob("remove", idList));
+  }
+
+ private:
+  // Reply after configured latency, without blocking other calls.
+  template <typename T>
+  T reply(const T& value) {
+    if (options_.latency <= 0 || !this->calledFromDBus()) {
+      return value;
+    }
+    this->setDelayedReply(true);
+    QDBusMessage msg = this->message().createReply();
+    if (QVariant::fromValue(value).isValid()) {
+      msg << QVariant::fromValue(value);
+    }
+    QTimer::singleShot(options_.latency, [msg]() {
+      QDBusConnection::sessionBus().send(msg);
+    });
+    return value;
+  }
+
+  QDBusObjectPath startJob(const QString& type, const QStringList& packages) {
+    FakeJob* job = this->addJob(type, packages);
+    job->Start();
+    return QDBusObjectPath(job->path());
+  }
+
+  FakeJob* addJob(const QString& type, const QStringList& packages) {
+    const QString id = QString::number(++last_job_id_);
+    FakeJob* job = new FakeJob(id, packages.join(" "), type, packages,
+                               options_, this);
+    QDBusConnection::sessionBus().registerObject(
+        job->path(), job,
+        QDBusConnection::ExportScriptableSlots |
+            QDBusConnection::ExportAllProperties);
+    connect(job, &FakeJob::finished, this, &FakeDebBackend::removeJob);
+    jobs_.insert(job->path(), job);
+    this->notifyJobList();
+    return job;
+  }
+
+  void removeJob(const QString& path) {
+    FakeJob* job = jobs_.take(path);
+    if (job == nullptr) {
+      return;
+    }
+    QDBusConnection::sessionBus().unregisterObject(path);
+    job->deleteLater();
+    this->notifyJobList();
+  }
+
+  void notifyJobList() {
+    EmitPropertiesChanged(dstore::kLastoreDebDbusPath, kDebIface, {
+      { "JobList", QVariant::fromValue(this->jobList()) },
+    });
+  }
+
+  Options options_;
+  QHash<QString, FakeJob*> jobs_;
+  int last_job_id_ = 0;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Stand-in of deepin-appstore-daemon deb backend on session bus");
+  parser.addHelpOption();
+  parser.addOptions({
+    { "latency", "Delay of each reply in milliseconds.", "ms", "0" },
+    { "packages", "Number of installed packages.", "n", "100" },
+    { "jobs", "Number of paused jobs created at startup.", "n", "0" },
+    { "progress-rate", "Progress updates per second.", "hz", "10" },
+    { "progress-step", "Progress added in each update.", "step", "0.01" },
+  });
+  parser.process(app);
+
+  Options options;
+  options.latency = parser.value("latency").toInt();
+  options.packages = parser.value("packages").toInt();
+  options.jobs = parser.value("jobs").toInt();
+  options.progress_rate = parser.value("progress-rate").toInt();
+  options.progress_step = parser.value("progress-step").toDouble();
+
+  AppVersion::registerMetaType();
+  InstalledAppInfo::registerMetaType();
+  InstalledAppTimestamp::registerMetaType();
+
+  QDBusConnection bus = QDBusConnection::sessionBus();
+  FakeDebBackend backend(options, &app);
+  if (!bus.registerObject(dstore::kLastoreDebDbusPath, &backend,
+                          QDBusConnection::ExportScriptableSlots |
+                              QDBusConnection::ExportAllProperties)) {
+    qCritical() << "failed to register object" << bus.lastError();
+    return 1;
+  }
+  if (!bus.registerService(dstore::kLastoreDebDbusService)) {
+    qCritical() << "failed to register service" << bus.lastError();
+    return 1;
+  }
+
+  return app.exec();
+}
+
+#include "fake_lastore_daemon.moc"
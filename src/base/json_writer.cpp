@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/json_writer.h"
+
+#include <cmath>
+
+#include <QLocale>
+#include <QStringList>
+
+namespace dstore {
+
+namespace {
+
+const char kHexDigits[] = "0123456789abcdef";
+
+void AppendDouble(double value, QByteArray& out) {
+  // JSON has no representation of NaN and infinity.
+  if (std::isnan(value) || std::isinf(value)) {
+    out.append("null");
+    return;
+  }
+  out.append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+}
+
+template <typename Map>
+void AppendObject(const Map& map, QByteArray& out) {
+  out.append('{');
+  bool first = true;
+  for (auto iter = map.cbegin(); iter != map.cend(); ++iter) {
+    if (!first) {
+      out.append(',');
+    }
+    first = false;
+    AppendJsonString(iter.key(), out);
+    out.append(':');
+    AppendJson(iter.value(), out);
+  }
+  out.append('}');
+}
+
+template <typename List>
+void AppendArray(const List& list, QByteArray& out) {
+  out.append('[');
+  bool first = true;
+  for (const auto& item : list) {
+    if (!first) {
+      out.append(',');
+    }
+    first = false;
+    AppendJson(item, out);
+  }
+  out.append(']');
+}
+
+}  // namespace
+
+void AppendJsonString(const QString& str, QByteArray& out) {
+  out.append('"');
+  const QChar* data = str.constData();
+  const int size = str.size();
+  // Copy runs of characters needing no escape in one conversion.
+  int run_start = 0;
+  for (int i = 0; i < size; ++i) {
+    const ushort c = data[i].unicode();
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    if (i > run_start) {
+      out.append(QString::fromRawData(data + run_start, i - run_start)
+                     .toUtf8());
+    }
+    run_start = i + 1;
+    switch (c) {
+      case '"': out.append("\\\""); break;
+      case '\\': out.append("\\\\"); break;
+      case '\b': out.append("\\b"); break;
+      case '\f': out.append("\\f"); break;
+      case '\n': out.append("\\n"); break;
+      case '\r': out.append("\\r"); break;
+      case '\t': out.append("\\t"); break;
+      default: {
+        out.append("\\u00");
+        out.append(kHexDigits[(c >> 4) & 0xf]);
+        out.append(kHexDigits[c & 0xf]);
+      }
+    }
+  }
+  if (size > run_start) {
+    out.append(QString::fromRawData(data + run_start, size - run_start)
+                   .toUtf8());
+  }
+  out.append('"');
+}
+
+void AppendJson(const QVariant& value, QByteArray& out) {
+  switch (static_cast<int>(value.type())) {
+    case QMetaType::UnknownType: {
+      out.append("null");
+      break;
+    }
+    case QMetaType::Bool: {
+      out.append(value.toBool() ? "true" : "false");
+      break;
+    }
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::Short:
+    case QMetaType::LongLong: {
+      out.append(QByteArray::number(value.toLongLong()));
+      break;
+    }
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::UShort:
+    case QMetaType::ULongLong: {
+      out.append(QByteArray::number(value.toULongLong()));
+      break;
+    }
+    case QMetaType::Float:
+    case QMetaType::Double: {
+      AppendDouble(value.toDouble(), out);
+      break;
+    }
+    case QMetaType::QString: {
+      AppendJsonString(value.toString(), out);
+      break;
+    }
+    case QMetaType::QVariantMap: {
+      AppendObject(value.toMap(), out);
+      break;
+    }
+    case QMetaType::QVariantHash: {
+      AppendObject(value.toHash(), out);
+      break;
+    }
+    case QMetaType::QVariantList: {
+      AppendArray(value.toList(), out);
+      break;
+    }
+    case QMetaType::QStringList: {
+      AppendArray(value.toStringList(), out);
+      break;
+    }
+    default: {
+      if (value.isNull() || !value.canConvert<QString>()) {
+        out.append("null");
+      } else {
+        AppendJsonString(value.toString(), out);
+      }
+    }
+  }
+}
+
+QByteArray ToCompactJson(const QVariant& value) {
+  QByteArray out;
+  AppendJson(value, out);
+  return out;
+}
+
+}  // namespace dstore
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEEPIN_APPSTORE_BASE_JSON_WRITER_H
+#define DEEPIN_APPSTORE_BASE_JSON_WRITER_H
+
+#include <QByteArray>
+#include <QVariant>
+
+namespace dstore {
+
+// Append |value| to |out| as compact UTF-8 JSON text.
+// Maps, lists and scalars are written as they are walked, no QJsonValue
+// tree is built. Types without JSON counterpart are written as strings
+// if convertible, or null otherwise.
+void AppendJson(const QVariant& value, QByteArray& out);
+
+// Append |str| to |out| as quoted and escaped JSON string.
+void AppendJsonString(const QString& str, QByteArray& out);
+
+// Returns |value| in compact JSON text, same as
+// QJsonDocument::toJson(QJsonDocument::Compact) but without converting to
+// QJsonDocument first.
+QByteArray ToCompactJson(const QVariant& value);
+
+}  // namespace dstore
+
+#endif  // DEEPIN_APPSTORE_BASE_JSON_WRITER_H
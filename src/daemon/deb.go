@@ -45,6 +45,8 @@ type Backend struct {
 	methods          *struct {
 		Install               func() `in:"localizedName,id" out:"job"`
 		Remove                func() `in:"localizedName,id" out:"job"`
+		InstallPackages       func() `in:"localizedName,idList" out:"job"`
+		RemovePackages        func() `in:"localizedName,idList" out:"job"`
 		ListInstalled         func() `out:"installedInfoList"`
 		QueryVersion          func() `in:"idList" out:"versionInfoList"`
 		QueryDownloadSize     func() `in:"id" out:"size"`
@@ -177,7 +179,9 @@ func (*Backend) GetInterfaceName() string {
 	return dbusBackendDebInterface
 }
 
-func (b *Backend) addJob(jobPath dbus.ObjectPath) (dbus.ObjectPath, error) {
+// addJob exports lastore job at jobPath, idList is set for batch jobs to
+// track status of each package.
+func (b *Backend) addJob(jobPath dbus.ObjectPath, idList []string) (dbus.ObjectPath, error) {
 	log.Println("add job", jobPath)
 
 	b.PropsMu.Lock()
@@ -188,7 +192,7 @@ func (b *Backend) addJob(jobPath dbus.ObjectPath) (dbus.ObjectPath, error) {
 		return job.getPath(), nil
 	}
 
-	job, err := newJob(b, jobPath)
+	job, err := newJob(b, jobPath, idList)
 	if err != nil {
 		return "/", err
 	}
@@ -226,7 +230,7 @@ func (b *Backend) Install(localizedName, id string) (dbus.ObjectPath, *dbus.Erro
 		return "/", dbusutil.ToError(err)
 	}
 
-	myJobPath, err := b.addJob(jobPath)
+	myJobPath, err := b.addJob(jobPath, nil)
 	if err != nil {
 		return "/", dbusutil.ToError(err)
 	}
@@ -245,7 +249,52 @@ func (b *Backend) Remove(localizedName, id string) (dbus.ObjectPath, *dbus.Error
 		return "/", dbusutil.ToError(err)
 	}
 
-	myJobPath, err := b.addJob(jobPath)
+	myJobPath, err := b.addJob(jobPath, nil)
+	if err != nil {
+		return "/", dbusutil.ToError(err)
+	}
+	return myJobPath, nil
+}
+
+// InstallPackages install all packages of idList in one job
+func (b *Backend) InstallPackages(localizedName string, idList []string) (dbus.ObjectPath, *dbus.Error) {
+	b.service.DelayAutoQuit()
+	log.Printf("install packages %q %q\n", localizedName, idList)
+	if len(idList) == 0 {
+		return "/", dbusutil.ToError(errors.New("empty package list"))
+	}
+
+	b.block.remove(idList...)
+
+	// lastore accepts space separated package list as one transaction
+	jobPath, err := b.lastore.InstallPackage(0, localizedName, strings.Join(idList, " "))
+	if err != nil {
+		return "/", dbusutil.ToError(err)
+	}
+
+	myJobPath, err := b.addJob(jobPath, idList)
+	if err != nil {
+		return "/", dbusutil.ToError(err)
+	}
+	return myJobPath, nil
+}
+
+// RemovePackages remove all packages of idList in one job
+func (b *Backend) RemovePackages(localizedName string, idList []string) (dbus.ObjectPath, *dbus.Error) {
+	b.service.DelayAutoQuit()
+	log.Printf("remove packages %q %q\n", localizedName, idList)
+	if len(idList) == 0 {
+		return "/", dbusutil.ToError(errors.New("empty package list"))
+	}
+
+	b.block.add(idList...)
+
+	jobPath, err := b.lastore.RemovePackage(0, localizedName, strings.Join(idList, " "))
+	if err != nil {
+		return "/", dbusutil.ToError(err)
+	}
+
+	myJobPath, err := b.addJob(jobPath, idList)
 	if err != nil {
 		return "/", dbusutil.ToError(err)
 	}
@@ -261,7 +310,7 @@ func (b *Backend) FixError(errType string) (dbus.ObjectPath, *dbus.Error) {
 		return "/", dbusutil.ToError(err)
 	}
 
-	myJobPath, err := b.addJob(jobPath)
+	myJobPath, err := b.addJob(jobPath, nil)
 	if err != nil {
 		return "/", dbusutil.ToError(err)
 	}
@@ -489,6 +538,26 @@ func getInstallationTime(id string) (int64, error) {
 	return t.Unix(), nil
 }
 
+// queryPackagesInstalled checks dpkg status of package ids with a single
+// dpkg-query, ids are either plain or arch qualified package names.
+func queryPackagesInstalled(ids []string) map[string]bool {
+	installed := make(map[string]bool, len(ids))
+	args := append([]string{"--show", "-f",
+		"${Package}:${Architecture}\\t${db:Status-Abbrev}\\n"}, ids...)
+	// dpkg-query fails if any of ids is unknown, but still prints the others.
+	out, _ := exec.Command("/usr/bin/dpkg-query", args...).Output()
+	for _, line := range bytes.Split(out, []byte{'\n'}) {
+		parts := bytes.SplitN(line, []byte{'\t'}, 2)
+		if len(parts) != 2 || !bytes.HasPrefix(parts[1], []byte("ii")) {
+			continue
+		}
+		name := string(parts[0])
+		installed[name] = true
+		installed[strings.SplitN(name, ":", 2)[0]] = true
+	}
+	return installed
+}
+
 // CleanArchives clean package cache
 func (b *Backend) CleanArchives() *dbus.Error {
 	b.service.DelayAutoQuit()
@@ -33,6 +33,8 @@ type Job struct {
 	Name       string
 	Packages   []string
 	CreateTime int64
+	// packages of batch job => status of each package
+	PackageStatus map[string]dbus.Variant
 }
 
 // GetInterfaceName return dbus interface name
@@ -44,7 +46,9 @@ func (j *Job) getPath() dbus.ObjectPath {
 	return dbus.ObjectPath(dbusJobPathPrefix + j.ID)
 }
 
-func newJob(backend *Backend, path dbus.ObjectPath) (*Job, error) {
+// newJob wraps lastore job at path, idList is set for batch jobs to track
+// status of each package.
+func newJob(backend *Backend, path dbus.ObjectPath, idList []string) (*Job, error) {
 	conn := backend.sysSigLoop.Conn()
 	core, err := lastore.NewJob(conn, path)
 	if err != nil {
@@ -71,14 +75,18 @@ func newJob(backend *Backend, path dbus.ObjectPath) (*Job, error) {
 	job.Speed, _ = core.Speed().Get(0)
 	job.DownloadSize, _ = core.DownloadSize().Get(0)
 	job.Cancelable, _ = core.Cancelable().Get(0)
+	if len(idList) > 1 {
+		job.PropsMu.Lock()
+		job.initPackageStatus(idList)
+		job.PropsMu.Unlock()
+	}
 
 	core.InitSignalExt(backend.sysSigLoop, true)
 	core.ConnectPropertiesChanged(func(interfaceName string,
 		changedProperties map[string]dbus.Variant, invalidatedProperties []string) {
 
 		job.PropsMu.Lock()
-		defer job.PropsMu.Unlock()
-
+		statusChanged := false
 		for propName, variant := range changedProperties {
 			value := variant.Value()
 			switch propName {
@@ -91,6 +99,7 @@ func newJob(backend *Backend, path dbus.ObjectPath) (*Job, error) {
 				status, ok := value.(string)
 				if ok {
 					job.setPropStatus(status)
+					statusChanged = true
 				}
 			case "Progress":
 				progress, ok := value.(float64)
@@ -123,11 +132,77 @@ func newJob(backend *Backend, path dbus.ObjectPath) (*Job, error) {
 				}
 			}
 		}
+		status := job.Status
+		var ids []string
+		if statusChanged {
+			ids = job.packageIDs()
+		}
+		job.PropsMu.Unlock()
+
+		if len(ids) > 0 {
+			job.followPackageStatus(status, ids)
+		}
 	})
 
 	return job, nil
 }
 
+// initPackageStatus must be called with PropsMu held.
+func (j *Job) initPackageStatus(idList []string) {
+	j.PackageStatus = make(map[string]dbus.Variant, len(idList))
+	for _, id := range idList {
+		j.PackageStatus[id] = dbus.MakeVariant(j.Status)
+	}
+}
+
+// packageIDs returns packages of batch job, must be called with PropsMu
+// held.
+func (j *Job) packageIDs() []string {
+	ids := make([]string, 0, len(j.PackageStatus))
+	for id := range j.PackageStatus {
+		ids = append(ids, id)
+	}
+	return ids
+}
+
+// followPackageStatus follow job status for each package of batch job,
+// result of each package is checked with dpkg database when job ends.
+// dpkg database is read without holding PropsMu.
+func (j *Job) followPackageStatus(status string, ids []string) {
+	var installed map[string]bool
+	if status == "succeed" || status == "failed" {
+		// lastore reports whole transaction only
+		installed = queryPackagesInstalled(ids)
+	}
+
+	j.PropsMu.Lock()
+	defer j.PropsMu.Unlock()
+	// Status changed again while dpkg was queried, newer one is handled
+	// by its own signal.
+	if j.Status != status {
+		return
+	}
+
+	packageStatus := make(map[string]dbus.Variant, len(ids))
+	for _, id := range ids {
+		switch status {
+		case "succeed", "failed":
+			if installed[id] == (j.Type != "remove") {
+				packageStatus[id] = dbus.MakeVariant("succeed")
+			} else {
+				packageStatus[id] = dbus.MakeVariant("failed")
+			}
+		default:
+			packageStatus[id] = dbus.MakeVariant(status)
+		}
+	}
+	j.PackageStatus = packageStatus
+	err := j.service.EmitPropertyChanged(j, "PackageStatus", packageStatus)
+	if err != nil {
+		log.Println("warning:", err)
+	}
+}
+
 // Start this job
 func (j *Job) Start() *dbus.Error {
 	err := j.backend.lastore.StartJob(dbus.FlagNoAutoStart, j.ID)
@@ -100,13 +100,17 @@ func newBlocklist() *blocklist {
 	return b
 }
 
-func (b *blocklist) add(id string) {
-	b.list[id] = ""
+func (b *blocklist) add(ids ...string) {
+	for _, id := range ids {
+		b.list[id] = ""
+	}
 	b.saveBlocklist()
 }
 
-func (b *blocklist) remove(id string) {
-	delete(b.list, id)
+func (b *blocklist) remove(ids ...string) {
+	for _, id := range ids {
+		delete(b.list, id)
+	}
 	b.saveBlocklist()
 }
 
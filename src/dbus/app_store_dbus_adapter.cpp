@@ -33,6 +33,14 @@ AppStoreDBusAdapter::~AppStoreDBusAdapter()
     // destructor
 }
 
+QString AppStoreDBusAdapter::DumpDBusStats()
+{
+    // handle method call com.deepin.AppStore.DumpDBusStats
+    QString out0;
+    QMetaObject::invokeMethod(parent(), "DumpDBusStats", Q_RETURN_ARG(QString, out0));
+    return out0;
+}
+
 void AppStoreDBusAdapter::Raise()
 {
     // handle method call com.deepin.AppStore.Raise
@@ -36,6 +36,9 @@ class AppStoreDBusAdapter: public QDBusAbstractAdaptor
 "    <method name=\"ShowAppDetail\">\n"
 "      <arg direction=\"in\" type=\"s\"/>\n"
 "    </method>\n"
+"    <method name=\"DumpDBusStats\">\n"
+"      <arg direction=\"out\" type=\"s\"/>\n"
+"    </method>\n"
 "  </interface>\n"
         "")
 public:
@@ -44,6 +47,7 @@ public:
 
 public: // PROPERTIES
 public Q_SLOTS: // METHODS
+    QString DumpDBusStats();
     void Raise();
     void ShowAppDetail(const QString &in0);
 Q_SIGNALS: // SIGNALS
@@ -36,6 +36,12 @@ public:
     ~AppStoreDBusInterface();
 
 public Q_SLOTS: // METHODS
+    inline QDBusPendingReply<QString> DumpDBusStats()
+    {
+        QList<QVariant> argumentList;
+        return asyncCallWithArgumentList(QStringLiteral("DumpDBusStats"), argumentList);
+    }
+
     inline QDBusPendingReply<> Raise()
     {
         QList<QVariant> argumentList;
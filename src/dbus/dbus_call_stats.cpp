@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dbus/dbus_call_stats.h"
+
+#include <QDBusPendingCallWatcher>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+namespace {
+
+const char kPropIface[] = "org.freedesktop.DBus.Properties";
+
+// Upper bounds of latency histogram buckets in milliseconds, the last
+// bucket holds slower calls.
+const qint64 kLatencyBuckets[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500,
+                                   1000, 2000, 5000 };
+const int kLatencyBucketCount =
+    sizeof(kLatencyBuckets) / sizeof(kLatencyBuckets[0]) + 1;
+
+struct CallStats {
+  qint64 calls = 0;
+  qint64 errors = 0;
+  qint64 total = 0;
+  qint64 max = 0;
+  QVector<qint64> histogram = QVector<qint64>(kLatencyBucketCount);
+};
+
+// Interfaces are used in several threads.
+struct CallStatsTable {
+  QMutex mutex;
+  // interface.method => stats
+  QMap<QString, CallStats> stats;
+};
+
+Q_GLOBAL_STATIC(CallStatsTable, g_call_stats);
+
+void RecordCall(const QString& method, qint64 elapsed, bool error) {
+  int bucket = 0;
+  while (bucket < kLatencyBucketCount - 1 &&
+         elapsed > kLatencyBuckets[bucket]) {
+    bucket++;
+  }
+
+  QMutexLocker locker(&g_call_stats->mutex);
+  CallStats& stats = g_call_stats->stats[method];
+  stats.calls++;
+  if (error) {
+    stats.errors++;
+  }
+  stats.total += elapsed;
+  stats.max = qMax(stats.max, elapsed);
+  stats.histogram[bucket]++;
+}
+
+// Replies are timed in a thread of their own, which is idle, so that
+// latency does not include events queued before reply in caller thread.
+class CallTimingThread {
+ public:
+  CallTimingThread() {
+    thread.setObjectName("DBusCallTiming");
+    thread.start();
+  }
+
+  ~CallTimingThread() {
+    thread.quit();
+    thread.wait();
+  }
+
+  QThread thread;
+};
+
+Q_GLOBAL_STATIC(CallTimingThread, g_timing_thread);
+
+// Record |call| of |method| started at |timer| once its reply arrives.
+void TimeCall(const QString& method,
+              const QDBusPendingCall& call,
+              const QElapsedTimer& timer) {
+  auto watcher = new QDBusPendingCallWatcher(call);
+  // Queued reply notification is moved along with watcher.
+  watcher->moveToThread(&g_timing_thread->thread);
+  QObject::connect(watcher, &QDBusPendingCallWatcher::finished,
+                   watcher, [method, timer](QDBusPendingCallWatcher* w) {
+    RecordCall(method, timer.elapsed(), w->isError());
+    w->deleteLater();
+  });
+}
+
+}  // namespace
+
+QDBusPendingCall TimedAsyncCall(QDBusAbstractInterface* iface,
+                                const QString& method,
+                                const QList<QVariant>& args) {
+  QElapsedTimer timer;
+  timer.start();
+  const QDBusPendingCall call = iface->asyncCallWithArgumentList(method, args);
+  TimeCall(iface->interface() + "." + method, call, timer);
+  return call;
+}
+
+QVariant TimedProperty(const QDBusAbstractInterface* iface, const char* name) {
+  QElapsedTimer timer;
+  timer.start();
+  const QVariant value = iface->property(name);
+  RecordCall(QString("%1.Get(%2)").arg(iface->interface(),
+                                       QString::fromLatin1(name)),
+             timer.elapsed(), iface->lastError().isValid());
+  return value;
+}
+
+QDBusPendingCall TimedGetProperty(const QDBusAbstractInterface* iface,
+                                  const char* name) {
+  QDBusMessage msg = QDBusMessage::createMethodCall(
+      iface->service(), iface->path(), kPropIface, "Get");
+  msg << iface->interface() << QString::fromLatin1(name);
+  QElapsedTimer timer;
+  timer.start();
+  const QDBusPendingCall call = iface->connection().asyncCall(msg);
+  TimeCall(QString("%1.Get(%2)").arg(iface->interface(),
+                                     QString::fromLatin1(name)),
+           call, timer);
+  return call;
+}
+
+QDBusPendingCall TimedGetAll(const QDBusAbstractInterface* iface) {
+  QDBusMessage msg = QDBusMessage::createMethodCall(
+      iface->service(), iface->path(), kPropIface, "GetAll");
+  msg << iface->interface();
+  QElapsedTimer timer;
+  timer.start();
+  const QDBusPendingCall call = iface->connection().asyncCall(msg);
+  TimeCall(iface->interface() + ".GetAll", call, timer);
+  return call;
+}
+
+QString DumpDBusCallStats() {
+  QString header = QString("%1 %2 %3 %4 %5 |")
+      .arg("method", -56)
+      .arg("calls", 7)
+      .arg("errors", 7)
+      .arg("avg", 8)
+      .arg("max", 8);
+  for (const qint64 bound : kLatencyBuckets) {
+    header += QString(" %1").arg("<=" + QString::number(bound), 7);
+  }
+  header += QString(" %1").arg(">" +
+      QString::number(kLatencyBuckets[kLatencyBucketCount - 2]), 7);
+
+  QStringList lines { header };
+  QMutexLocker locker(&g_call_stats->mutex);
+  for (auto iter = g_call_stats->stats.cbegin();
+       iter != g_call_stats->stats.cend(); ++iter) {
+    const CallStats& stats = iter.value();
+    QString line = QString("%1 %2 %3 %4 %5 |")
+        .arg(iter.key(), -56)
+        .arg(stats.calls, 7)
+        .arg(stats.errors, 7)
+        .arg(double(stats.total) / qMax(stats.calls, qint64(1)), 8, 'f', 1)
+        .arg(stats.max, 8);
+    for (const qint64 count : stats.histogram) {
+      line += QString(" %1").arg(count, 7);
+    }
+    lines.append(line);
+  }
+  return lines.join("\n");
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEEPIN_APPSTORE_DBUS_DBUS_CALL_STATS_H
+#define DEEPIN_APPSTORE_DBUS_DBUS_CALL_STATS_H
+
+#include <QDBusAbstractInterface>
+#include <QDBusPendingCall>
+
+// Count, errors and latency of DBus calls are recorded per method by these
+// wrappers, which are called by generated interfaces in place of
+// QDBusAbstractInterface methods.
+
+/**
+ * Same as |iface|->asyncCallWithArgumentList(), latency is measured until
+ * reply arrives, whether caller blocks on it or handles it later.
+ */
+QDBusPendingCall TimedAsyncCall(QDBusAbstractInterface* iface,
+                                const QString& method,
+                                const QList<QVariant>& args);
+
+/**
+ * Same as |iface|->property(), which reads the property with a blocking
+ * Properties.Get call, recorded as method "Get(name)".
+ */
+QVariant TimedProperty(const QDBusAbstractInterface* iface, const char* name);
+
+/**
+ * Read property |name| of |iface| with Properties.Get, without blocking,
+ * recorded as method "Get(name)".
+ */
+QDBusPendingCall TimedGetProperty(const QDBusAbstractInterface* iface,
+                                  const char* name);
+
+/**
+ * Read all properties of |iface| with one Properties.GetAll call.
+ */
+QDBusPendingCall TimedGetAll(const QDBusAbstractInterface* iface);
+
+/**
+ * Returns call statistics of each method as a text table, in
+ * milliseconds, for debugging.
+ */
+QString DumpDBusCallStats();
+
+#endif  // DEEPIN_APPSTORE_DBUS_DBUS_CALL_STATS_H
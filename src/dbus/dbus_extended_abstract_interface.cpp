@@ -60,6 +60,7 @@ void DbusExtendedAbstractInterface::propertyChanged(const QDBusMessage& msg) {
 
   const QVariantMap changed_props = qdbus_cast<QVariantMap>(
       arguments.at(1).value<QDBusArgument>());
+  emit this->propertiesChanged(changed_props);
   for (const QString& prop : changed_props.keys()) {
     const QMetaObject* self = this->metaObject();
     for (int i = self->propertyOffset(); i < self->propertyCount(); ++i) {
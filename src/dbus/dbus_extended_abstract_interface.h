@@ -35,6 +35,13 @@ class DbusExtendedAbstractInterface : public QDBusAbstractInterface {
 
   ~DbusExtendedAbstractInterface();
 
+ signals:
+  /**
+   * Emitted with new values of changed properties, before notify signals
+   * of these properties.
+   */
+  void propertiesChanged(const QVariantMap& changed);
+
  private slots:
   void propertyChanged(const QDBusMessage& msg);
 };
@@ -19,6 +19,7 @@ qdbusxml2cpp com.deepin.AppStore.Backend.Deb.xml \
   -i dbus/dbus_variant/app_version.h \
   -i dbus/dbus_variant/installed_app_info.h \
   -i dbus/dbus_variant/installed_app_timestamp.h \
+  -i dbus/dbus_call_stats.h \
   -i dbus/dbus_extended_abstract_interface.h \
   -c LastoreDebInterface \
   -l DbusExtendedAbstractInterface \
@@ -26,5 +27,12 @@ qdbusxml2cpp com.deepin.AppStore.Backend.Deb.xml \
 
 qdbusxml2cpp com.deepin.AppStore.Backend.Job.xml \
   -p lastore_job_interface \
+  -i dbus/dbus_call_stats.h \
   -c LastoreJobInterface \
-  -N
\ No newline at end of file
+  -N
+
+# Record calls of backend interfaces, see dbus_call_stats.h.
+sed -i \
+  -e 's/return asyncCallWithArgumentList(/return TimedAsyncCall(this, /' \
+  -e 's/(property("\([A-Za-z]*\)"))/(TimedProperty(this, "\1"))/' \
+  lastore_deb_interface.h lastore_job_interface.h
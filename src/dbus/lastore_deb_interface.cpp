@@ -1,6 +1,6 @@
 /*
  * This file was generated by qdbusxml2cpp version 0.8
- * Command line was: qdbusxml2cpp com.deepin.AppStore.Backend.Deb.xml -p lastore_deb_interface -i dbus/dbus_variant/app_version.h -i dbus/dbus_variant/installed_app_info.h -i dbus/dbus_variant/installed_app_timestamp.h -i dbus/dbus_extended_abstract_interface.h -c LastoreDebInterface -l DbusExtendedAbstractInterface -N
+ * Command line was: qdbusxml2cpp com.deepin.AppStore.Backend.Deb.xml -p lastore_deb_interface -i dbus/dbus_variant/app_version.h -i dbus/dbus_variant/installed_app_info.h -i dbus/dbus_variant/installed_app_timestamp.h -i dbus/dbus_call_stats.h -i dbus/dbus_extended_abstract_interface.h -c LastoreDebInterface -l DbusExtendedAbstractInterface -N
  *
  * qdbusxml2cpp is Copyright (C) 2016 The Qt Company Ltd.
  *
@@ -1,6 +1,6 @@
 /*
  * This file was generated by qdbusxml2cpp version 0.8
- * Command line was: qdbusxml2cpp com.deepin.AppStore.Backend.Deb.xml -p lastore_deb_interface -i dbus/dbus_variant/app_version.h -i dbus/dbus_variant/installed_app_info.h -i dbus/dbus_variant/installed_app_timestamp.h -i dbus/dbus_extended_abstract_interface.h -c LastoreDebInterface -l DbusExtendedAbstractInterface -N
+ * Command line was: qdbusxml2cpp com.deepin.AppStore.Backend.Deb.xml -p lastore_deb_interface -i dbus/dbus_variant/app_version.h -i dbus/dbus_variant/installed_app_info.h -i dbus/dbus_variant/installed_app_timestamp.h -i dbus/dbus_call_stats.h -i dbus/dbus_extended_abstract_interface.h -c LastoreDebInterface -l DbusExtendedAbstractInterface -N
  *
  * qdbusxml2cpp is Copyright (C) 2016 The Qt Company Ltd.
  *
@@ -22,6 +22,7 @@
 #include "dbus/dbus_variant/app_version.h"
 #include "dbus/dbus_variant/installed_app_info.h"
 #include "dbus/dbus_variant/installed_app_timestamp.h"
+#include "dbus/dbus_call_stats.h"
 #include "dbus/dbus_extended_abstract_interface.h"
 
 /*
@@ -41,61 +42,75 @@ public:
 
     Q_PROPERTY(QList<QDBusObjectPath> JobList READ jobList NOTIFY jobListChanged)
     inline QList<QDBusObjectPath> jobList() const
-    { return qvariant_cast< QList<QDBusObjectPath> >(property("JobList")); }
+    { return qvariant_cast< QList<QDBusObjectPath> >(TimedProperty(this, "JobList")); }
 
 public Q_SLOTS: // METHODS
     inline QDBusPendingReply<> CleanArchives()
     {
         QList<QVariant> argumentList;
-        return asyncCallWithArgumentList(QStringLiteral("CleanArchives"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("CleanArchives"), argumentList);
     }
 
     inline QDBusPendingReply<QDBusObjectPath> FixError(const QString &errType)
     {
         QList<QVariant> argumentList;
         argumentList << QVariant::fromValue(errType);
-        return asyncCallWithArgumentList(QStringLiteral("FixError"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("FixError"), argumentList);
     }
 
     inline QDBusPendingReply<QDBusObjectPath> Install(const QString &localName, const QString &id)
     {
         QList<QVariant> argumentList;
         argumentList << QVariant::fromValue(localName) << QVariant::fromValue(id);
-        return asyncCallWithArgumentList(QStringLiteral("Install"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("Install"), argumentList);
+    }
+
+    inline QDBusPendingReply<QDBusObjectPath> InstallPackages(const QString &localName, const QStringList &idList)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(localName) << QVariant::fromValue(idList);
+        return TimedAsyncCall(this, QStringLiteral("InstallPackages"), argumentList);
     }
 
     inline QDBusPendingReply<InstalledAppInfoList> ListInstalled()
     {
         QList<QVariant> argumentList;
-        return asyncCallWithArgumentList(QStringLiteral("ListInstalled"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("ListInstalled"), argumentList);
     }
 
     inline QDBusPendingReply<qlonglong> QueryDownloadSize(const QString &id)
     {
         QList<QVariant> argumentList;
         argumentList << QVariant::fromValue(id);
-        return asyncCallWithArgumentList(QStringLiteral("QueryDownloadSize"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("QueryDownloadSize"), argumentList);
     }
 
     inline QDBusPendingReply<InstalledAppTimestampList> QueryInstallationTime(const QStringList &idList)
     {
         QList<QVariant> argumentList;
         argumentList << QVariant::fromValue(idList);
-        return asyncCallWithArgumentList(QStringLiteral("QueryInstallationTime"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("QueryInstallationTime"), argumentList);
     }
 
     inline QDBusPendingReply<AppVersionList> QueryVersion(const QStringList &idList)
     {
         QList<QVariant> argumentList;
         argumentList << QVariant::fromValue(idList);
-        return asyncCallWithArgumentList(QStringLiteral("QueryVersion"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("QueryVersion"), argumentList);
     }
 
     inline QDBusPendingReply<QDBusObjectPath> Remove(const QString &localName, const QString &id)
     {
         QList<QVariant> argumentList;
         argumentList << QVariant::fromValue(localName) << QVariant::fromValue(id);
-        return asyncCallWithArgumentList(QStringLiteral("Remove"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("Remove"), argumentList);
+    }
+
+    inline QDBusPendingReply<QDBusObjectPath> RemovePackages(const QString &localName, const QStringList &idList)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(localName) << QVariant::fromValue(idList);
+        return TimedAsyncCall(this, QStringLiteral("RemovePackages"), argumentList);
     }
 
 Q_SIGNALS: // SIGNALS
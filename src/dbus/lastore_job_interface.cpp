@@ -1,6 +1,6 @@
 /*
  * This file was generated by qdbusxml2cpp version 0.8
- * Command line was: qdbusxml2cpp com.deepin.AppStore.Backend.Job.xml -p lastore_job_interface -c LastoreJobInterface -N
+ * Command line was: qdbusxml2cpp com.deepin.AppStore.Backend.Job.xml -p lastore_job_interface -i dbus/dbus_call_stats.h -c LastoreJobInterface -N
  *
  * qdbusxml2cpp is Copyright (C) 2016 The Qt Company Ltd.
  *
@@ -1,6 +1,6 @@
 /*
  * This file was generated by qdbusxml2cpp version 0.8
- * Command line was: qdbusxml2cpp com.deepin.AppStore.Backend.Job.xml -p lastore_job_interface -c LastoreJobInterface -N
+ * Command line was: qdbusxml2cpp com.deepin.AppStore.Backend.Job.xml -p lastore_job_interface -i dbus/dbus_call_stats.h -c LastoreJobInterface -N
  *
  * qdbusxml2cpp is Copyright (C) 2016 The Qt Company Ltd.
  *
@@ -19,6 +19,7 @@
 #include <QtCore/QStringList>
 #include <QtCore/QVariant>
 #include <QtDBus/QtDBus>
+#include "dbus/dbus_call_stats.h"
 
 /*
  * Proxy class for interface com.deepin.AppStore.Backend.Job
@@ -37,65 +38,69 @@ public:
 
     Q_PROPERTY(bool Cancelable READ cancelable)
     inline bool cancelable() const
-    { return qvariant_cast< bool >(property("Cancelable")); }
+    { return qvariant_cast< bool >(TimedProperty(this, "Cancelable")); }
 
     Q_PROPERTY(qlonglong CreateTime READ createTime)
     inline qlonglong createTime() const
-    { return qvariant_cast< qlonglong >(property("CreateTime")); }
+    { return qvariant_cast< qlonglong >(TimedProperty(this, "CreateTime")); }
 
     Q_PROPERTY(QString Description READ description)
     inline QString description() const
-    { return qvariant_cast< QString >(property("Description")); }
+    { return qvariant_cast< QString >(TimedProperty(this, "Description")); }
 
     Q_PROPERTY(qlonglong DownloadSize READ downloadSize)
     inline qlonglong downloadSize() const
-    { return qvariant_cast< qlonglong >(property("DownloadSize")); }
+    { return qvariant_cast< qlonglong >(TimedProperty(this, "DownloadSize")); }
 
     Q_PROPERTY(QString Id READ id)
     inline QString id() const
-    { return qvariant_cast< QString >(property("Id")); }
+    { return qvariant_cast< QString >(TimedProperty(this, "Id")); }
 
     Q_PROPERTY(QString Name READ name)
     inline QString name() const
-    { return qvariant_cast< QString >(property("Name")); }
+    { return qvariant_cast< QString >(TimedProperty(this, "Name")); }
+
+    Q_PROPERTY(QVariantMap PackageStatus READ packageStatus)
+    inline QVariantMap packageStatus() const
+    { return qvariant_cast< QVariantMap >(TimedProperty(this, "PackageStatus")); }
 
     Q_PROPERTY(QStringList Packages READ packages)
     inline QStringList packages() const
-    { return qvariant_cast< QStringList >(property("Packages")); }
+    { return qvariant_cast< QStringList >(TimedProperty(this, "Packages")); }
 
     Q_PROPERTY(double Progress READ progress)
     inline double progress() const
-    { return qvariant_cast< double >(property("Progress")); }
+    { return qvariant_cast< double >(TimedProperty(this, "Progress")); }
 
     Q_PROPERTY(qlonglong Speed READ speed)
     inline qlonglong speed() const
-    { return qvariant_cast< qlonglong >(property("Speed")); }
+    { return qvariant_cast< qlonglong >(TimedProperty(this, "Speed")); }
 
     Q_PROPERTY(QString Status READ status)
     inline QString status() const
-    { return qvariant_cast< QString >(property("Status")); }
+    { return qvariant_cast< QString >(TimedProperty(this, "Status")); }
 
     Q_PROPERTY(QString Type READ type)
     inline QString type() const
-    { return qvariant_cast< QString >(property("Type")); }
+    { return qvariant_cast< QString >(TimedProperty(this, "Type")); }
 
 public Q_SLOTS: // METHODS
     inline QDBusPendingReply<> Clean()
     {
         QList<QVariant> argumentList;
-        return asyncCallWithArgumentList(QStringLiteral("Clean"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("Clean"), argumentList);
     }
 
     inline QDBusPendingReply<> Pause()
     {
         QList<QVariant> argumentList;
-        return asyncCallWithArgumentList(QStringLiteral("Pause"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("Pause"), argumentList);
     }
 
     inline QDBusPendingReply<> Start()
     {
         QList<QVariant> argumentList;
-        return asyncCallWithArgumentList(QStringLiteral("Start"), argumentList);
+        return TimedAsyncCall(this, QStringLiteral("Start"), argumentList);
     }
 
 Q_SIGNALS: // SIGNALS
@@ -24,6 +24,7 @@
 #include "dbus/app_store_dbus_adapter.h"
 #include "dbus/app_store_dbus_interface.h"
 #include "dbus/dbus_consts.h"
+#include "dbus/dbus_call_stats.h"
 
 namespace dstore {
 
@@ -88,6 +89,12 @@ bool DBusManager::parseArguments() {
   return false;
 }
 
+QString DBusManager::DumpDBusStats() {
+  const QString stats = DumpDBusCallStats();
+  qDebug().noquote() << "dbus call stats:\n" << stats;
+  return stats;
+}
+
 void DBusManager::Raise() {
   emit this->raiseRequested();
 }
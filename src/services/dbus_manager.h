@@ -40,6 +40,8 @@ class DBusManager : public QObject {
 
  public slots:
   // Implement AppStore dbus service.
+  // Log and return call statistics of backend dbus interfaces.
+  QString DumpDBusStats();
   void Raise();
   void ShowDetail(const QString& app_name);
 
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "services/job_registry.h"
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDebug>
+
+#include "dbus/dbus_call_stats.h"
+#include "dbus/dbus_consts.h"
+#include "dbus/lastore_job_interface.h"
+
+namespace dstore
+{
+
+namespace
+{
+
+const char kPropertiesInterface[] = "org.freedesktop.DBus.Properties";
+
+QDBusError InvalidJobError(const QString &path)
+{
+    return QDBusError(QDBusError::UnknownObject, "invalid job " + path);
+}
+
+// Nested containers in a{sv} are left as QDBusArgument by QtDBus.
+QVariantMap UnwrapProperties(const QVariantMap &props)
+{
+    QVariantMap result;
+    for (auto iter = props.cbegin(); iter != props.cend(); ++iter) {
+        QVariant value = iter.value();
+        if (value.userType() == qMetaTypeId<QDBusArgument>()) {
+            const QDBusArgument argument = value.value<QDBusArgument>();
+            if (argument.currentType() == QDBusArgument::MapType) {
+                value = qdbus_cast<QVariantMap>(argument);
+            } else if (argument.currentType() == QDBusArgument::ArrayType) {
+                value = qdbus_cast<QStringList>(argument);
+            }
+        }
+        result.insert(iter.key(), value);
+    }
+    return result;
+}
+
+}  // namespace
+
+JobRegistry::JobRegistry(QObject *parent)
+    : QObject(parent)
+{
+    // Empty path matches all of jobs exported by backend.
+    QDBusConnection::sessionBus().connect(
+        kLastoreDebJobService,
+        "",
+        kPropertiesInterface,
+        "PropertiesChanged",
+        this,
+        SLOT(onPropertiesChanged(QDBusMessage)));
+}
+
+JobRegistry::~JobRegistry()
+{
+}
+
+void JobRegistry::sync(const QStringList &paths)
+{
+    paths_ = paths;
+    for (const QString &path : jobs_.keys()) {
+        if (!paths.contains(path)) {
+            JobEntry removed = jobs_.take(path);
+            removed.proxy->deleteLater();
+            for (auto &waiter : removed.waiters) {
+                waiter(QVariantMap(), InvalidJobError(path));
+            }
+        }
+    }
+
+    for (const QString &path : paths) {
+        if (!jobs_.contains(path)) {
+            JobEntry job_entry;
+            job_entry.proxy = new LastoreJobInterface(kLastoreDebJobService,
+                                                      path,
+                                                      QDBusConnection::sessionBus(),
+                                                      this);
+            jobs_.insert(path, job_entry);
+            this->fetchAll(path);
+        }
+    }
+}
+
+QStringList JobRegistry::paths() const
+{
+    return paths_;
+}
+
+LastoreJobInterface *JobRegistry::job(const QString &path)
+{
+    auto iter = jobs_.find(path);
+    return (iter == jobs_.end()) ? nullptr : iter->proxy;
+}
+
+void JobRegistry::properties(const QString &path, PropertiesCallback callback)
+{
+    auto iter = jobs_.find(path);
+    if (iter == jobs_.end()) {
+        callback(QVariantMap(), InvalidJobError(path));
+        return;
+    }
+    if (iter->loaded) {
+        callback(iter->properties, QDBusError());
+        return;
+    }
+    iter->waiters.append(callback);
+    this->fetchAll(path);
+}
+
+void JobRegistry::onPropertiesChanged(const QDBusMessage &message)
+{
+    const QList<QVariant> arguments = message.arguments();
+    if (arguments.length() < 3 ||
+            arguments.at(0).toString() != LastoreJobInterface::staticInterfaceName()) {
+        return;
+    }
+
+    auto iter = jobs_.find(message.path());
+    if (iter == jobs_.end() || !iter->loaded) {
+        // Pending GetAll reply contains the new values.
+        return;
+    }
+
+    const QVariantMap changed = UnwrapProperties(
+                                    qdbus_cast<QVariantMap>(arguments.at(1)));
+    for (auto prop = changed.cbegin(); prop != changed.cend(); ++prop) {
+        iter->properties.insert(prop.key(), prop.value());
+    }
+    if (!changed.isEmpty()) {
+        emit this->jobChanged(message.path(), changed);
+    }
+
+    const QStringList invalidated = qdbus_cast<QStringList>(arguments.at(2));
+    if (!invalidated.isEmpty()) {
+        iter->loaded = false;
+        this->fetchAll(message.path());
+    }
+}
+
+void JobRegistry::fetchAll(const QString &path)
+{
+    auto iter = jobs_.find(path);
+    if (iter == jobs_.end() || iter->fetching) {
+        return;
+    }
+    iter->fetching = true;
+
+    const QDBusPendingCall call = TimedGetAll(iter->proxy);
+    auto watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished,
+    this, [this, path](QDBusPendingCallWatcher * w) {
+        w->deleteLater();
+        const QDBusPendingReply<QVariantMap> reply = *w;
+        auto iter = jobs_.find(path);
+        // Dropped meanwhile, its waiters are already answered.
+        if (iter == jobs_.end()) {
+            return;
+        }
+        iter->fetching = false;
+        const QList<PropertiesCallback> waiters = iter->waiters;
+        iter->waiters.clear();
+        if (reply.isError()) {
+            qWarning() << path << reply.error();
+            for (auto &waiter : waiters) {
+                waiter(QVariantMap(), reply.error());
+            }
+            return;
+        }
+        iter->properties = UnwrapProperties(reply.value());
+        iter->loaded = true;
+        const QVariantMap props = iter->properties;
+        for (auto &waiter : waiters) {
+            waiter(props, QDBusError());
+        }
+    });
+}
+
+}  // namespace dstore
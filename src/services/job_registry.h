@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEEPIN_APPSTORE_SERVICES_JOB_REGISTRY_H
+#define DEEPIN_APPSTORE_SERVICES_JOB_REGISTRY_H
+
+#include <functional>
+
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QVariantMap>
+
+class LastoreJobInterface;
+
+namespace dstore
+{
+
+/**
+ * Keeps state of backend jobs in memory, keyed by job path.
+ * Properties of a job are fetched once with Properties.GetAll and kept
+ * up to date with PropertiesChanged signal.
+ */
+class JobRegistry : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobRegistry(QObject *parent = nullptr);
+    ~JobRegistry() override;
+
+    /**
+     * Receives properties of a job, or |error| if they are not available.
+     */
+    typedef std::function<void(const QVariantMap &props,
+                               const QDBusError &error)> PropertiesCallback;
+
+    /**
+     * Track jobs in |paths| and drop all of the others.
+     */
+    void sync(const QStringList &paths);
+
+    /**
+     * Returns tracked jobs, in order of last sync().
+     */
+    QStringList paths() const;
+
+    /**
+     * Returns the proxy object of |path|, it is reused between calls.
+     * Returns nullptr if |path| is not in job list.
+     */
+    LastoreJobInterface *job(const QString &path);
+
+    /**
+     * Read properties of |path| from cache, or from pending GetAll call if
+     * they are not fetched yet. Paths not in job list fail at once.
+     */
+    void properties(const QString &path, PropertiesCallback callback);
+
+Q_SIGNALS:
+    /**
+     * Emitted when properties of a tracked job are changed.
+     * @param path
+     * @param changed new values of changed properties only
+     */
+    void jobChanged(const QString &path, const QVariantMap &changed);
+
+private Q_SLOTS:
+    void onPropertiesChanged(const QDBusMessage &message);
+
+private:
+    struct JobEntry {
+        LastoreJobInterface *proxy = nullptr;
+        QVariantMap properties;
+        bool loaded = false;
+        bool fetching = false;
+        // Waiting for GetAll reply.
+        QList<PropertiesCallback> waiters;
+    };
+
+    void fetchAll(const QString &path);
+
+    QHash<QString, JobEntry> jobs_;
+    QStringList paths_;
+};
+
+}  // namespace dstore
+
+#endif  // DEEPIN_APPSTORE_SERVICES_JOB_REGISTRY_H
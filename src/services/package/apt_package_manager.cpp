@@ -1,9 +1,13 @@
 #include "apt_package_manager.h"
 
-#include <QEventLoop>
-#include <QCoreApplication>
+#include <QDataStream>
+#include <QDBusPendingCallWatcher>
+#include <QSaveFile>
+#include <QSharedPointer>
 
 #include "base/command.h"
+#include "base/consts.h"
+#include "base/file_util.h"
 #include "base/launcher.h"
 
 #include "dbus/dbus_consts.h"
@@ -16,6 +20,7 @@
 #include "services/store_daemon_manager.h"
 
 #include "apt_util_worker.h"
+#include "single_flight.h"
 
 namespace dstore
 {
@@ -33,6 +38,142 @@ static QStringList getIDs(const QList<Package> &packages)
     return packageIDs;
 }
 
+// Local names of |packages| shown in job description.
+static QString getLocalNames(const QList<Package> &packages)
+{
+    QStringList localNames;
+    for (auto &package : packages) {
+        localNames << package.localName;
+    }
+    return localNames.join(", ");
+}
+
+// Returns packageURI of deb package |packageID|.
+static QString DebPackageURI(const QString &packageID)
+{
+    return QStringLiteral("dpk://deb/") + packageID;
+}
+
+typedef std::function<void(const QDBusPendingCall &)> ReplyHandler;
+
+// Calls |handler| with the reply of |call| once it is finished, without
+// blocking the event loop of |context| thread.
+static void WatchReply(const QDBusPendingCall &call,
+                       QObject *context,
+                       ReplyHandler handler)
+{
+    auto watcher = new QDBusPendingCallWatcher(call, context);
+    QObject::connect(watcher, &QDBusPendingCallWatcher::finished,
+    watcher, [handler](QDBusPendingCallWatcher * w) {
+        handler(*w);
+        w->deleteLater();
+    });
+}
+
+const char kInstalledSnapshotFile[] = "installed_packages.dat";
+const quint32 kInstalledSnapshotMagic = 0x44505354;  // "DPST"
+const quint32 kInstalledSnapshotVersion = 1;
+
+static QString InstalledSnapshotPath()
+{
+    return QDir(GetCacheDir()).absoluteFilePath(kInstalledSnapshotFile);
+}
+
+// Snapshot file layout: magic, format version, compressed QDataStream
+// of InstalledAppInfoList.
+static void WriteInstalledSnapshot(const InstalledAppInfoList &list)
+{
+    QByteArray payload;
+    QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+    payloadStream.setVersion(QDataStream::Qt_5_6);
+    payloadStream << list;
+
+    // Written to a temporary file and renamed over the old snapshot, so
+    // that a crash or another instance never leaves a torn file.
+    const QString path = InstalledSnapshotPath();
+    QSaveFile file(path);
+    if (!CreateParentDirs(path) || !file.open(QIODevice::WriteOnly)) {
+        qWarning() << "failed to save installed snapshot" << path;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << kInstalledSnapshotMagic
+           << kInstalledSnapshotVersion
+           << qCompress(payload);
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "failed to save installed snapshot" << path;
+    }
+}
+
+static bool ReadInstalledSnapshot(InstalledAppInfoList &list)
+{
+    const QString path = InstalledSnapshotPath();
+    QByteArray data;
+    if (!QFile::exists(path) || !ReadRawFile(path, data)) {
+        return false;
+    }
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_6);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray compressed;
+    stream >> magic >> version >> compressed;
+    if (stream.status() != QDataStream::Ok ||
+            magic != kInstalledSnapshotMagic ||
+            version != kInstalledSnapshotVersion) {
+        qWarning() << "ignore invalid installed snapshot" << path;
+        return false;
+    }
+
+    const QByteArray payload = qUncompress(compressed);
+    QDataStream payloadStream(payload);
+    payloadStream.setVersion(QDataStream::Qt_5_6);
+    payloadStream >> list;
+    return payloadStream.status() == QDataStream::Ok;
+}
+
+// Returns |entries| of backend reply, keyed by package names, rekeyed by
+// requested |ids|. An id is answered by the entry of exactly the same name,
+// or else by the entry of the same package ID.
+template <typename T>
+static QMap<QString, T> MatchRequested(const QStringList &ids,
+                                       const QMap<QString, T> &entries)
+{
+    QHash<QString, T> byID;
+    for (auto iter = entries.cbegin(); iter != entries.cend(); ++iter) {
+        byID.insert(PackageIDFromName(iter.key()), iter.value());
+    }
+    QMap<QString, T> result;
+    for (auto &id : ids) {
+        if (entries.contains(id)) {
+            result.insert(id, entries.value(id));
+        } else if (byID.contains(PackageIDFromName(id))) {
+            result.insert(id, byID.value(PackageIDFromName(id)));
+        }
+    }
+    return result;
+}
+
+static QVariantList InstalledToVariantList(const InstalledAppInfoList &list)
+{
+    QVariantList result;
+    for (const InstalledAppInfo &info : list) {
+        Package pkg;
+        pkg.packageName = info.packageName;
+        pkg.appName = info.appName;
+        auto packageID = PackageIDFromName(pkg.packageName);
+        pkg.localVersion = info.version;
+        pkg.size = info.size;
+        pkg.dpk = DpkURI(DebPackageURI(packageID));
+        pkg.allLocalName = SharedLocaleNames(info.localeNames);
+        pkg.installedTime = info.installationTime;
+        result.append(pkg.toVariantMap());
+    }
+    return result;
+}
+
 }  // namespace
 
 class AptPackageManagerPrivate
@@ -58,6 +199,48 @@ public:
         apt_worker_thread_->wait(3);
     }
 
+    /*!
+     * \brief Collect job path of |call| for each of |packages|, which share
+     * one job, keyed by packageURI.
+     */
+    void watchJob(const QList<Package> &packages,
+                  const QDBusPendingCall &call,
+                  PMJobCallback callback)
+    {
+        Q_Q(AptPackageManager);
+        WatchReply(call, q,
+        [packages, callback](const QDBusPendingCall & call) {
+            const QDBusPendingReply<QDBusObjectPath> reply = call;
+            if (reply.isError()) {
+                qWarning() << reply.error();
+                callback(PMJobResult::dbusError(reply.error()));
+                return;
+            }
+
+            JobPathMap result;
+            for (auto &package : packages) {
+                result.insert(package.packageURI(), reply.value().path());
+            }
+            callback(PMJobResult::warp(result));
+        });
+    }
+
+    /*!
+     * \brief Query version and installation time of |packageIDs| together,
+     * packages are keyed by requested ids.
+     */
+    void fetchQuery(const QStringList &packageIDs,
+                    SingleFlight<Package>::Callback callback);
+
+    /*!
+     * \brief Query version of |packageIDs|, keyed by requested ids.
+     */
+    void fetchVersion(const QStringList &packageIDs,
+                      SingleFlight<QVariantMap>::Callback callback);
+
+    // Concurrent requests of the same package share one backend call.
+    SingleFlight<Package> query_flight_;
+    SingleFlight<QVariantMap> version_flight_;
 
     AptUtilWorker *apt_worker_ = nullptr;
     QThread *apt_worker_thread_ = nullptr;
@@ -68,6 +251,123 @@ public:
     Q_DECLARE_PUBLIC(AptPackageManager)
 };
 
+void AptPackageManagerPrivate::fetchQuery(const QStringList &packageIDs,
+                                          SingleFlight<Package>::Callback callback)
+{
+    Q_Q(AptPackageManager);
+
+    // Version and installation time are independent, query them together
+    // and merge them when both replies arrive.
+    struct QueryJoin {
+        int pending = 2;
+        QDBusError error;
+        AppVersionList versions;
+        InstalledAppTimestampList timestamps;
+    };
+    auto join = QSharedPointer<QueryJoin>::create();
+
+    auto finish = [join, packageIDs, callback]() {
+        if (--join->pending > 0) {
+            return;
+        }
+
+        if (join->error.isValid()) {
+            callback(join->error, SingleFlight<Package>::ValueMap());
+            return;
+        }
+
+        QMap<QString, AppVersion> versions;
+        for (const AppVersion &version : join->versions) {
+            versions.insert(version.pkg_name, version);
+        }
+        QMap<QString, qlonglong> timestamps;
+        for (const InstalledAppTimestamp &timestamp : join->timestamps) {
+            timestamps.insert(timestamp.pkg_name, timestamp.timestamp);
+        }
+
+        // Packages are keyed and named by requested ids.
+        const auto matched_versions = MatchRequested(packageIDs, versions);
+        const auto matched_timestamps = MatchRequested(packageIDs, timestamps);
+        QMap<QString, Package> result;
+        for (auto iter = matched_versions.cbegin();
+                iter != matched_versions.cend(); ++iter) {
+            const AppVersion &version = iter.value();
+            // TODO: remove name
+            Package pkg;
+            pkg.dpk = DpkURI(DebPackageURI(iter.key()));
+            pkg.packageName = version.pkg_name;
+            pkg.localVersion = version.installed_version;
+            pkg.remoteVersion = version.remote_version;
+            pkg.upgradable = version.upgradable;
+            pkg.appName = PackageIDFromName(iter.key());
+            pkg.installedTime = matched_timestamps.value(iter.key(), 0);
+            result.insert(iter.key(), pkg);
+        }
+
+        callback(QDBusError(), result);
+    };
+
+    WatchReply(deb_interface_->QueryVersion(packageIDs), q,
+    [join, finish](const QDBusPendingCall & call) {
+        const QDBusPendingReply<AppVersionList> reply = call;
+        if (reply.isError()) {
+            qWarning() << reply.error();
+            join->error = reply.error();
+        } else {
+            join->versions = reply.value();
+        }
+        finish();
+    });
+
+    WatchReply(deb_interface_->QueryInstallationTime(packageIDs), q,
+    [join, finish](const QDBusPendingCall & call) {
+        const QDBusPendingReply<InstalledAppTimestampList> reply = call;
+        if (reply.isError()) {
+            qWarning() << reply.error();
+            join->error = reply.error();
+        } else {
+            join->timestamps = reply.value();
+        }
+        finish();
+    });
+}
+
+void AptPackageManagerPrivate::fetchVersion(const QStringList &packageIDs,
+                                            SingleFlight<QVariantMap>::Callback callback)
+{
+    Q_Q(AptPackageManager);
+
+    WatchReply(deb_interface_->QueryVersion(packageIDs), q,
+    [packageIDs, callback](const QDBusPendingCall & call) {
+        const QDBusPendingReply<AppVersionList> reply = call;
+        if (reply.isError()) {
+            qWarning() << reply.error();
+            callback(reply.error(), SingleFlight<QVariantMap>::ValueMap());
+            return;
+        }
+
+        QMap<QString, AppVersion> versions;
+        for (const AppVersion &version : reply.value()) {
+            versions.insert(version.pkg_name, version);
+        }
+        const auto matched = MatchRequested(packageIDs, versions);
+        SingleFlight<QVariantMap>::ValueMap result;
+        for (auto iter = matched.cbegin(); iter != matched.cend(); ++iter) {
+            const AppVersion &version = iter.value();
+            // TODO: remove name
+            result.insert(iter.key(), QVariantMap {
+                { "dpk", DebPackageURI(iter.key()) },
+                { "name", PackageIDFromName(iter.key()) },
+                { "localVersion", version.installed_version },
+                { "remoteVersion", version.remote_version },
+                { "upgradable", version.upgradable },
+            });
+        }
+
+        callback(QDBusError(), result);
+    });
+}
+
 AptPackageManager::AptPackageManager(QObject *parent) :
     PackageManagerInterface(parent), dd_ptr(new AptPackageManagerPrivate(this))
 {
@@ -86,268 +386,180 @@ PMResult AptPackageManager::Open(const QString &packageID)
     return PMResult::warp({});
 }
 
-PMResult AptPackageManager::Query(const QList<Package> &packages)
+void AptPackageManager::Query(const QList<Package> &packages, PMPackageCallback callback)
 {
     Q_D(AptPackageManager);
-    auto packageIDs = getIDs(packages);
-
-    const QDBusPendingReply<AppVersionList> reply =
-        d->deb_interface_->QueryVersion(packageIDs);
-
-    while (!reply.isFinished()) {
-        qApp->processEvents();
-    }
-
-    if (reply.isError()) {
-        qWarning() << reply.error();
-        return PMResult::dbusError(reply.error());
-    }
-
-    const AppVersionList version_list = reply.value();
-    QMap<QString, Package> result;
-    for (const AppVersion &version : version_list) {
-        auto package_name = version.pkg_name;
-        auto packageID =  package_name.split(":").first();
-        // TODO: remove name
-        Package pkg;
-        pkg.packageURI = "dpk://deb/" + packageID;
-        pkg.packageName = package_name;
-        pkg.localVersion = version.installed_version;
-        pkg.remoteVersion = version.remote_version;
-        pkg.upgradable = version.upgradable;
-        pkg.appName = packageID;
-        result.insert(packageID, pkg);
-    }
 
-    const QDBusPendingReply<InstalledAppTimestampList> installTimeReply =
-        d->deb_interface_->QueryInstallationTime(packageIDs);
-    if (installTimeReply.isError()) {
-        qDebug() << installTimeReply.error();
-        return PMResult::dbusError(installTimeReply.error());
-    }
+    d->query_flight_.run(getIDs(packages),
+    [d](const QStringList & ids, SingleFlight<Package>::Callback cb) {
+        d->fetchQuery(ids, cb);
+    },
+    [callback](const QDBusError & error, const QMap<QString, Package> &result) {
+        if (error.isValid()) {
+            callback(PMPackageResult::dbusError(error));
+            return;
+        }
 
-    while (!installTimeReply.isFinished()) {
-        qApp->processEvents();
-    }
+        PackageMap data;
+        for (auto &p : result) {
+            data.insert(p.packageURI(), p);
+        }
+        callback(PMPackageResult::warp(data));
+    });
+}
 
-    const InstalledAppTimestampList timestamp_list = installTimeReply.value();
+void AptPackageManager::QueryDownloadSize(const QList<Package> &packages, PMPackageCallback callback)
+{
+    Q_D(AptPackageManager);
 
-    for (const InstalledAppTimestamp &timestamp : timestamp_list) {
-        auto package_name = timestamp.pkg_name;
-        auto packageID =  package_name.split(":").first();
-        auto pkg = result.value(package_name);
-        pkg.installedTime =  timestamp.timestamp;
-        result.insert(package_name, pkg);
+    if (packages.isEmpty()) {
+        callback(PMPackageResult::warp(PackageMap()));
+        return;
     }
 
-    QVariantMap data;
-    for (auto &p : result) {
-        data.insert(p.packageURI, p.toVariantMap());
+    // Send all of queries at once and merge replies as they arrive,
+    // a failed package does not abort the others.
+    auto data = QSharedPointer<PackageMap>::create();
+    auto errors = QSharedPointer<QVariantMap>::create();
+    auto pending = QSharedPointer<int>::create(packages.length());
+    for (auto &package : packages) {
+        const QString packageName = package.dpk.getID();
+        const QString packageURI = package.packageURI();
+        WatchReply(d->deb_interface_->QueryDownloadSize(packageName), this,
+        [ = ](const QDBusPendingCall & call) {
+            const QDBusPendingReply<qlonglong> sizeReply = call;
+            if (sizeReply.isError()) {
+                qWarning() << packageName << sizeReply.error();
+                errors->insert(packageURI, PMPackageResult::packageError(sizeReply.error()));
+            } else {
+                Package pkg;
+                auto packageID = PackageIDFromName(packageName);
+                pkg.dpk = DpkURI(DebPackageURI(packageID));
+                pkg.packageName = packageName;
+                pkg.size = 0;
+                pkg.downloadSize = sizeReply.value();
+                data->insert(pkg.packageURI(), pkg);
+            }
+
+            if (--(*pending) == 0) {
+                callback(PMPackageResult::batch(*data, *errors));
+            }
+        });
     }
-
-    return PMResult::warp(data);
 }
 
-PMResult AptPackageManager::QueryDownloadSize(const QList<Package> &packages)
+void AptPackageManager::QueryVersion(const QList<Package> &packages, PMCallback callback)
 {
     Q_D(AptPackageManager);
 
-    auto packageIDs = getIDs(packages);
-
-    QMap<QString, Package> result;
-    for (auto &packageName : packageIDs) {
-        const QDBusPendingReply<qlonglong> sizeReply =
-            d->deb_interface_->QueryDownloadSize(packageName);
-
-        while (!sizeReply.isFinished()) {
-            qApp->processEvents();
+    d->version_flight_.run(getIDs(packages),
+    [d](const QStringList & ids, SingleFlight<QVariantMap>::Callback cb) {
+        d->fetchVersion(ids, cb);
+    },
+    [callback](const QDBusError & error, const QMap<QString, QVariantMap> &versions) {
+        if (error.isValid()) {
+            callback(PMResult::dbusError(error));
+            return;
         }
 
-        if (sizeReply.isError()) {
-            qDebug() << sizeReply.error();
-            return PMResult::dbusError(sizeReply.error());
+        QVariantList result;
+        for (auto &version : versions) {
+            result.append(version);
         }
-
-        Package pkg;
-        auto packageID =  packageName.split(":").first();
-        pkg.packageURI = "dpk://deb/" + packageID;
-        pkg.packageName = packageName;
-        const qlonglong size = sizeReply.value();
-        pkg.size = 0;
-        pkg.downloadSize = size;
-
-        result.insert(packageName, pkg);
-    }
-
-
-    QVariantMap data;
-    for (auto &p : result) {
-        data.insert(p.packageURI, p.toVariantMap());
-    }
-
-//    qDebug() << data;
-    return PMResult::warp(data);
+        callback(PMResult::warp(result));
+    });
 }
 
-PMResult AptPackageManager::QueryVersion(const QList<Package> &packages)
+void AptPackageManager::QueryInstalledTime(const QList<Package> &packages, PMCallback callback)
 {
     Q_D(AptPackageManager);
     auto packageIDs = getIDs(packages);
 
-    const QDBusPendingReply<AppVersionList> reply =
-        d->deb_interface_->QueryVersion(packageIDs);
-
-    while (!reply.isFinished()) {
-        qApp->processEvents();
-    }
-
-    if (reply.isError()) {
-        qDebug() << reply.error();
-        return PMResult::dbusError(reply.error());
-    }
-
+    WatchReply(d->deb_interface_->QueryInstallationTime(packageIDs), this,
+    [callback](const QDBusPendingCall & call) {
+        const QDBusPendingReply<InstalledAppTimestampList> reply = call;
+        if (reply.isError()) {
+            qWarning() << reply.error();
+            callback(PMResult::dbusError(reply.error()));
+            return;
+        }
 
-    const AppVersionList version_list = reply.value();
-    QVariantList result;
-    for (const AppVersion &version : version_list) {
-        auto package_name = version.pkg_name;
-        auto packageID =  package_name.split(":").first();
-        // TODO: remove name
-        result.append(QVariantMap {
-            { "dpk", "dpk://deb/" + packageID },
-            { "name", packageID },
-            { "localVersion", version.installed_version },
-            { "remoteVersion", version.remote_version },
-            { "upgradable", version.upgradable },
-        });
-    }
+        const InstalledAppTimestampList timestamp_list = reply.value();
+        QVariantList result;
+        for (const InstalledAppTimestamp &timestamp : timestamp_list) {
+            auto package_name = timestamp.pkg_name;
+            auto packageID = PackageIDFromName(package_name);
+            result.append(QVariantMap {
+                { "dpk", DebPackageURI(packageID) },
+                { "app", packageID },
+                { "time", timestamp.timestamp },
+            });
+        }
 
-    return PMResult::warp(result);
+        callback(PMResult::warp(result));
+    });
 }
 
-PMResult AptPackageManager::QueryInstalledTime(const QList<Package> &packages)
+void AptPackageManager::ListInstalled(const QList<QString> &/*packageIDs*/, PMCallback callback)
 {
     Q_D(AptPackageManager);
-    auto packageIDs = getIDs(packages);
 
-    const QDBusPendingReply<InstalledAppTimestampList> reply =
-        d->deb_interface_->QueryInstallationTime(packageIDs);
-    if (reply.isError()) {
-        qDebug() << reply.error();
-        return PMResult::dbusError(reply.error());
-    }
-
-    const InstalledAppTimestampList timestamp_list = reply.value();
-    QVariantList result;
-    for (const InstalledAppTimestamp &timestamp : timestamp_list) {
-        auto package_name = timestamp.pkg_name;
-        auto packageID =  package_name.split(":").first();
-        result.append(QVariantMap {
-            { "dpk", "dpk://deb/" + packageID },
-            { "app", packageID },
-            { "time", timestamp.timestamp },
-        });
-    }
+    WatchReply(d->deb_interface_->ListInstalled(), this,
+    [callback](const QDBusPendingCall & call) {
+        const QDBusPendingReply<InstalledAppInfoList> reply = call;
+        if (reply.isError()) {
+            qWarning() << reply.error();
+            callback(PMResult::dbusError(reply.error()));
+            return;
+        }
 
-    return PMResult::warp(result);
+        const InstalledAppInfoList list = reply.value();
+        WriteInstalledSnapshot(list);
+        callback(PMResult::warp(InstalledToVariantList(list)));
+    });
 }
 
-PMResult AptPackageManager::ListInstalled(const QList<QString> &/*packageIDs*/)
+PMResult AptPackageManager::ListInstalledSnapshot()
 {
-    Q_D(AptPackageManager);
-//    auto packageIDs = getIDs(packages);
-
-    //TODO: remove
-//    QMap<QString, int> apps;
-//    for (auto id : packageIDs) {
-//        apps.insert(id, 1);
-//    }
-
-    const QDBusPendingReply<InstalledAppInfoList> reply =
-        d->deb_interface_->ListInstalled();
-    if (reply.isError()) {
-        qDebug() << reply.error();
-        return PMResult::dbusError(reply.error());
-    }
-
-    const InstalledAppInfoList list = reply.value();
-    QVariantList result;
-    for (const InstalledAppInfo &info : list) {
-        Package pkg;
-        pkg.packageName = info.packageName;
-        pkg.appName = info.appName;
-        auto packageID =   pkg.packageName.split(":").first();
-        pkg.localVersion = info.version;
-        pkg.size = info.size;
-        pkg.packageURI = "dpk://deb/" + packageID;
-        for (auto k : info.localeNames.keys()) {
-            pkg.allLocalName[k] = info.localeNames[k];
-        }
-        pkg.installedTime = info.installationTime;
-        // TODO: remove name
-//        if (apps.contains(packageID)) {
-        result.append(pkg.toVariantMap());
-//            qDebug() << info.pkg_name << info.size << info.version;
-//            break; // for debug
-//        }
+    InstalledAppInfoList list;
+    if (!ReadInstalledSnapshot(list)) {
+        return PMResult(false, "", "no installed snapshot", QVariantList());
     }
-
-    return PMResult::warp(result);
+    return PMResult::warp(InstalledToVariantList(list));
 }
 
-PMResult AptPackageManager::Install(const QList<Package> &packages)
+void AptPackageManager::Install(const QList<Package> &packages, PMJobCallback callback)
 {
     Q_D(AptPackageManager);
 
-    QMap<QString, QVariant> result;
-
-    for (auto &package : packages) {
-        qDebug() << package.packageURI << package.dpk.getID() << package.localName;
-        const QDBusPendingReply<QDBusObjectPath> reply =
-            d->deb_interface_->Install(package.localName, package.dpk.getID());
-
-        while (!reply.isFinished()) {
-            qApp->processEvents();
-        }
-
-        if (reply.isError()) {
-            qDebug() << reply.error();
-            return PMResult::dbusError(reply.error());
-        }
-
-        result.insert(package.packageURI, reply.value().path());
+    if (packages.isEmpty()) {
+        callback(PMJobResult::warp(JobPathMap()));
+        return;
     }
 
-    qDebug() << result;
-    return PMResult::warp(result);
-
+    // Several packages are installed in a single job, which reports status
+    // of each package.
+    const Package &package = packages.first();
+    const QDBusPendingCall call = (packages.length() == 1) ?
+                                  d->deb_interface_->Install(package.localName, package.dpk.getID()) :
+                                  d->deb_interface_->InstallPackages(getLocalNames(packages), getIDs(packages));
+    d->watchJob(packages, call, callback);
 }
 
-PMResult AptPackageManager::Remove(const QList<Package> &packages)
+void AptPackageManager::Remove(const QList<Package> &packages, PMJobCallback callback)
 {
     Q_D(AptPackageManager);
 
-    QMap<QString, QVariant> result;
-
-    for (auto &package : packages) {
-        qDebug() << package.packageURI << package.dpk.getID() << package.localName;
-        const QDBusPendingReply<QDBusObjectPath> reply =
-            d->deb_interface_->Remove(package.localName, package.dpk.getID());
-
-        while (!reply.isFinished()) {
-            qApp->processEvents();
-        }
-
-        if (reply.isError()) {
-            qDebug() << reply.error();
-            return PMResult::dbusError(reply.error());
-        }
-
-        result.insert(package.packageURI, reply.value().path());
+    if (packages.isEmpty()) {
+        callback(PMJobResult::warp(JobPathMap()));
+        return;
     }
 
-    qDebug() << result;
-    return PMResult::warp(result);
+    const Package &package = packages.first();
+    const QDBusPendingCall call = (packages.length() == 1) ?
+                                  d->deb_interface_->Remove(package.localName, package.dpk.getID()) :
+                                  d->deb_interface_->RemovePackages(getLocalNames(packages), getIDs(packages));
+    d->watchJob(packages, call, callback);
 }
 
 }
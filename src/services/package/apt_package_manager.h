@@ -20,15 +20,16 @@ Q_SIGNALS:
 
 public Q_SLOTS:
     virtual PMResult Open(const QString &packageID) override;
-    virtual PMResult Query(const QList<Package> &packages) override;
-    virtual PMResult QueryDownloadSize(const QList<Package> &packages) override;
-    virtual PMResult QueryVersion(const QList<Package> &packages) override;
-    virtual PMResult QueryInstalledTime(const QList<Package> &packages) override;
+    virtual void Query(const QList<Package> &packages, PMPackageCallback callback) override;
+    virtual void QueryDownloadSize(const QList<Package> &packages, PMPackageCallback callback) override;
+    virtual void QueryVersion(const QList<Package> &packages, PMCallback callback) override;
+    virtual void QueryInstalledTime(const QList<Package> &packages, PMCallback callback) override;
 
-    virtual PMResult ListInstalled(const QList<QString> &packageIDs) override;
+    virtual void ListInstalled(const QList<QString> &packageIDs, PMCallback callback) override;
+    virtual PMResult ListInstalledSnapshot() override;
 
-    virtual PMResult Install(const QList<Package> &packages) override;
-    virtual PMResult Remove(const QList<Package> &packages) override;
+    virtual void Install(const QList<Package> &packages, PMJobCallback callback) override;
+    virtual void Remove(const QList<Package> &packages, PMJobCallback callback) override;
 
 private:
     QScopedPointer<AptPackageManagerPrivate> dd_ptr;
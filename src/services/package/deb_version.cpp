@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2017 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deb_version.h"
+
+#include <QStringRef>
+
+namespace dstore
+{
+
+namespace
+{
+
+struct DebVersion {
+    explicit DebVersion(const QString &version)
+    {
+        QStringRef rest(&version);
+        const int colon = rest.indexOf(':');
+        if (colon > 0) {
+            epoch = rest.left(colon).toUInt();
+            rest = rest.mid(colon + 1);
+        }
+        const int hyphen = rest.lastIndexOf('-');
+        if (hyphen >= 0) {
+            revision = rest.mid(hyphen + 1);
+            rest = rest.left(hyphen);
+        }
+        upstream = rest;
+    }
+
+    uint epoch = 0;
+    QStringRef upstream;
+    QStringRef revision;
+};
+
+inline bool IsDigit(ushort c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool IsAlpha(ushort c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Sort weight of non-digit character, '~' sorts before everything,
+// even the end of string, letters sort before other characters.
+inline int Order(ushort c)
+{
+    if (IsDigit(c)) {
+        return 0;
+    } else if (IsAlpha(c)) {
+        return c;
+    } else if (c == '~') {
+        return -1;
+    } else if (c) {
+        return c + 256;
+    }
+    return 0;
+}
+
+// Port of verrevcmp() in dpkg lib/dpkg/version.c, 0 marks end of string.
+int CompareFragment(const QStringRef &a, const QStringRef &b)
+{
+    const ushort *pa = a.isEmpty() ? nullptr : a.utf16();
+    const ushort *pb = b.isEmpty() ? nullptr : b.utf16();
+    const int la = a.size();
+    const int lb = b.size();
+    int ia = 0;
+    int ib = 0;
+    auto at = [](const ushort * p, int len, int i) -> ushort {
+        return i < len ? p[i] : 0;
+    };
+
+    while (ia < la || ib < lb) {
+        int first_diff = 0;
+        while ((ia < la && !IsDigit(pa[ia])) || (ib < lb && !IsDigit(pb[ib]))) {
+            const int ac = Order(at(pa, la, ia));
+            const int bc = Order(at(pb, lb, ib));
+            if (ac != bc) {
+                return ac - bc;
+            }
+            ia++;
+            ib++;
+        }
+        while (at(pa, la, ia) == '0') {
+            ia++;
+        }
+        while (at(pb, lb, ib) == '0') {
+            ib++;
+        }
+        while (IsDigit(at(pa, la, ia)) && IsDigit(at(pb, lb, ib))) {
+            if (!first_diff) {
+                first_diff = pa[ia] - pb[ib];
+            }
+            ia++;
+            ib++;
+        }
+        if (IsDigit(at(pa, la, ia))) {
+            return 1;
+        }
+        if (IsDigit(at(pb, lb, ib))) {
+            return -1;
+        }
+        if (first_diff) {
+            return first_diff;
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+int CompareDebVersion(const QString &a, const QString &b)
+{
+    const DebVersion va(a);
+    const DebVersion vb(b);
+    if (va.epoch != vb.epoch) {
+        return va.epoch > vb.epoch ? 1 : -1;
+    }
+    const int result = CompareFragment(va.upstream, vb.upstream);
+    if (result) {
+        return result;
+    }
+    return CompareFragment(va.revision, vb.revision);
+}
+
+bool IsDebUpgradable(const QString &local, const QString &remote)
+{
+    if (local.isEmpty() || remote.isEmpty()) {
+        return false;
+    }
+    return CompareDebVersion(remote, local) > 0;
+}
+
+}  // namespace dstore
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2017 ~ 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+
+namespace dstore
+{
+
+/*!
+ * \brief Compares two Debian package versions, [epoch:]upstream[-revision],
+ * the same way as `dpkg --compare-versions`.
+ * \return negative if |a| is older than |b|, zero if equal, positive if newer.
+ */
+int CompareDebVersion(const QString &a, const QString &b);
+
+/*!
+ * \brief Returns true if |remote| is newer than installed |local| version.
+ * Packages not installed are not upgradable.
+ */
+bool IsDebUpgradable(const QString &local, const QString &remote);
+
+}  // namespace dstore
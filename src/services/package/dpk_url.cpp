@@ -17,7 +17,9 @@
 
 #include "dpk_url.h"
 
-#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 
 namespace dstore
 {
@@ -28,52 +30,94 @@ namespace
 const int kAppNameMaxLen = 64;
 const char kPkgDeb[] = "deb";
 const char kPkgFlatPak[] = "flatpak";
+const QLatin1String kDpkScheme("dpk://");
 
-enum class DpkURLValidationResult {
-    Ok,
-    InvalidFormat,
-    InvalidSchemeName,
-    InvalidPkgType,
-    AppNameTooShort,
-    AppNameTooLong,
+// Interned strings are pruned once table grows to this size.
+const int kInternMinPrune = 4096;
+
+// Strings are keyed by their hash, values with the same hash are
+// compared one by one. Packages are parsed in several threads.
+struct InternTable {
+    QMutex mutex;
+    QMultiHash<uint, QString> strings;
+    int prune_at = kInternMinPrune;
 };
 
-}  // namespace
+Q_GLOBAL_STATIC(InternTable, g_intern_table);
 
-DpkURLValidationResult IsValidDpkLink(const QString &uri)
+// Intern |ref|, |whole| is the string |ref| refers to if it covers
+// the whole string, so it is stored without copy.
+QString Intern(const QStringRef &ref, const QString *whole)
 {
-    const QStringList parts = uri.split('/');
-    if (parts.length() != 4) {
-        return DpkURLValidationResult::InvalidFormat;
+    if (ref.isEmpty()) {
+        return QString();
     }
 
-    // Case sensitive
-    if (parts.at(0) != "dpk:") {
-        return DpkURLValidationResult::InvalidSchemeName;
+    const uint hash = qHash(ref);
+    QMutexLocker locker(&g_intern_table->mutex);
+    auto &strings = g_intern_table->strings;
+    for (auto iter = strings.constFind(hash);
+            iter != strings.cend() && iter.key() == hash; ++iter) {
+        if (iter.value() == ref) {
+            return iter.value();
+        }
     }
 
-    if (!parts.at(1).isEmpty()) {
-        return DpkURLValidationResult::InvalidFormat;
+    if (strings.size() >= g_intern_table->prune_at) {
+        // Strings only referenced by table are not used any more.
+        for (auto iter = strings.begin(); iter != strings.end();) {
+            if (iter.value().isDetached()) {
+                iter = strings.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+        g_intern_table->prune_at = qMax(kInternMinPrune, strings.size() * 2);
     }
 
-    if (parts.at(2) != kPkgDeb && parts.at(2) != kPkgFlatPak) {
-        return DpkURLValidationResult::InvalidPkgType;
-    }
+    const QString interned = whole ? *whole : ref.toString();
+    strings.insert(hash, interned);
+    return interned;
+}
 
-    if (parts.at(3).length() > kAppNameMaxLen) {
-        return DpkURLValidationResult::AppNameTooLong;
+// Package types are constant, so they are shared without the table.
+QString PackageType(const QStringRef &ref)
+{
+    static const QString deb(kPkgDeb);
+    static const QString flatpak(kPkgFlatPak);
+    if (ref == deb) {
+        return deb;
     }
-    if (parts.at(3).isEmpty()) {
-        return DpkURLValidationResult::AppNameTooShort;
+    if (ref == flatpak) {
+        return flatpak;
     }
+    return QString();
+}
+
+}  // namespace
 
-    return DpkURLValidationResult::Ok;
+QString InternString(const QStringRef &str)
+{
+    return Intern(str, nullptr);
 }
 
+QString InternString(const QString &str)
+{
+    return Intern(QStringRef(&str), &str);
+}
+
+QString PackageIDFromName(const QString &packageName)
+{
+    const int colon = packageName.indexOf(':');
+    if (colon < 0) {
+        return InternString(packageName);
+    }
+    return InternString(packageName.leftRef(colon));
+}
 
 bool DpkURI::isValid() const
 {
-    return IsValidDpkLink(url) == DpkURLValidationResult::Ok;
+    return valid;
 }
 
 QString DpkURI::getType() const
@@ -86,17 +130,40 @@ QString DpkURI::getID() const
     return  id;
 }
 
+QString DpkURI::toString() const
+{
+    return url;
+}
 
 DpkURI::DpkURI(const QString &dpk)
+    : url(dpk)
 {
-    const QString schema = "dpk://";
-    url = dpk;
-    url.replace(dpk.indexOf(schema), schema.size(), "");
-    type = url.left(url.indexOf("/"));
-    id = url.right(url.length() - url.indexOf("/") - 1);
-
-    // store dpk to url
-    url = dpk;
+    // Parse and validate in one pass, without temporary strings.
+    const bool hasScheme = dpk.startsWith(kDpkScheme);
+    const int start = hasScheme ? kDpkScheme.size() : 0;
+    const int slash = dpk.indexOf('/', start);
+    if (slash < 0) {
+        return;
+    }
+
+    const QStringRef typeRef = dpk.midRef(start, slash - start);
+    const QStringRef idRef = dpk.midRef(slash + 1);
+
+    // Case sensitive
+    valid = hasScheme &&
+            (typeRef == QLatin1String(kPkgDeb) || typeRef == QLatin1String(kPkgFlatPak)) &&
+            !idRef.isEmpty() &&
+            idRef.length() <= kAppNameMaxLen &&
+            !idRef.contains('/');
+
+    // Strings sent by web page are only interned once they are valid.
+    if (valid) {
+        type = PackageType(typeRef);
+        id = InternString(idRef);
+    } else {
+        type = typeRef.toString();
+        id = idRef.toString();
+    }
 }
 
 }  // namespace dstore
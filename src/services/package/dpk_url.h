@@ -18,6 +18,7 @@
 #pragma once
 
 #include <QString>
+#include <QStringRef>
 
 namespace dstore
 {
@@ -35,11 +36,29 @@ public:
     bool isValid() const;
     QString getType() const;
     QString getID() const;
+    QString toString() const;
 
 private:
+    // Type and id of valid URI are interned, see InternString().
     QString url;
     QString type;
     QString id;
+    bool valid = false;
 };
 
+/*!
+ * \brief Returns the shared copy of |str|, equal package IDs and locale
+ * keys share one buffer among packages and result maps.
+ * Only allocates when |str| is seen for the first time, strings no longer
+ * used elsewhere are pruned as table grows.
+ */
+QString InternString(const QStringRef &str);
+QString InternString(const QString &str);
+
+/*!
+ * \brief Returns interned package ID without architecture suffix,
+ * e.g. "deepin-manual:amd64" => "deepin-manual".
+ */
+QString PackageIDFromName(const QString &packageName);
+
 }  // namespace dstore
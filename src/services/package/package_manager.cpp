@@ -5,6 +5,8 @@
 #include <functional>
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QSharedPointer>
 
 namespace dstore
 {
@@ -14,10 +16,54 @@ class PackageManagerPrivate
 public:
     PackageManagerPrivate(PackageManager *parent) : q_ptr(parent) {}
 
-    typedef PMResult PMHandler(const QString &, const QStringList &);
-    typedef PMResult PMPackageHandler(const QString &, const QList<Package> &);
+    /*!
+     * \brief Record latency of backend |type|, and its error if |result|
+     * failed. Error of the first failed backend is kept in |merged|.
+     */
+    template <typename T, typename R>
+    static void recordBackend(PMResultOf<T> &merged, const QString &type,
+                              qint64 elapsed, const PMResultOf<R> &result)
+    {
+        merged.latency.insert(type, elapsed);
+        if (!result.success) {
+            merged.backendErrors.insert(type, QVariantMap {
+                { "errorName", result.errName },
+                { "errorMsg", result.errMsg },
+            });
+            if (merged.backendErrors.size() == 1) {
+                merged.errName = result.errName;
+                merged.errMsg = result.errMsg;
+            }
+        }
+    }
+
+    /*!
+     * \brief Set status of |merged| once all of its |backends| replied.
+     * mergeRun() and mapRun() share one rule: merged result succeeds if any
+     * backend succeeded, data of failed backends is left out and their
+     * errors are listed in backendErrors. It fails with error of the first
+     * failed backend only if every backend failed.
+     */
+    template <typename T>
+    static void finishBackends(PMResultOf<T> &merged, int backends)
+    {
+        merged.success = merged.backendErrors.size() < backends;
+        if (merged.success) {
+            merged.errName.clear();
+            merged.errMsg.clear();
+        }
+    }
+
+    typedef void PMHandler(const QString &, const QStringList &, PMCallback);
+    typedef void PMPackageHandler(const QString &, const QList<Package> &, PMPackageCallback);
 
-    PMResult mergeRun(const QStringList &list, std::function<PMHandler> callback)
+    /*!
+     * \brief Dispatch |list| to backends and concatenate their lists.
+     * Succeeds if any backend succeeded, see finishBackends().
+     */
+    void mergeRun(const QStringList &list,
+                  std::function<PMHandler> handler,
+                  PMCallback callback)
     {
         QStringList dpks;
         for (auto appName : list) {
@@ -29,40 +75,91 @@ public:
             DpkURI dpk(packageURI);
             ids.insert(dpk.getType(), dpk.getID());
         }
-        QVariantList pkgList;
-        for (auto &key : pms.keys()) {
+
+        const auto keys = pms.keys();
+        if (keys.isEmpty()) {
+            callback(PMResult::warp(QVariantList()));
+            return;
+        }
+
+        // Backends reply in any order, join on the last one.
+        auto merged = QSharedPointer<PMResult>::create(true, "", "", QVariant());
+        auto pkgList = QSharedPointer<QVariantList>::create();
+        auto pending = QSharedPointer<int>::create(keys.length());
+        const int backends = keys.length();
+        for (auto &key : keys) {
             auto idList = ids.values(key);
-            auto result = callback(key, idList);
-            auto data = result.data.toList();
-            pkgList.append(data);
-        }
-        // TODO: error handle
-        return PMResult(true,
-                        "",
-                        "",
-                        pkgList);
+            QElapsedTimer timer;
+            timer.start();
+            handler(key, idList, [ = ](const PMResult & result) {
+                recordBackend(*merged, key, timer.elapsed(), result);
+                if (result.success) {
+                    pkgList->append(result.data.toList());
+                }
+                if (--(*pending) == 0) {
+                    merged->data = *pkgList;
+                    finishBackends(*merged, backends);
+                    callback(*merged);
+                }
+            });
+        }
     }
 
-    QMap<QString, QVariant> mapRun(QList<Package> list, std::function<PMPackageHandler> callback)
+    /*!
+     * \brief Dispatch |list| to backends and merge their typed results,
+     * keyed by packageURI.
+     * Succeeds if any backend succeeded, see finishBackends().
+     */
+    template <typename T>
+    void mapRun(QList<Package> list,
+                std::function<void(const QString &,
+                                   const QList<Package> &,
+                                   std::function<void(const PMResultOf<T> &)>)> handler,
+                std::function<void(const PMResultOf<T> &)> callback)
     {
-        QMultiHash<QString, QString> ids;
+        // Each backend only receives its own packages.
+        QMap<QString, QList<Package>> packageLists;
         for (auto &package : list) {
-            ids.insert(package.dpk.getType(), package.dpk.getID());
+            const QString type = package.dpk.getType();
+            if (pms.contains(type)) {
+                packageLists[type].append(package);
+            }
         }
 
-        QMap<QString, QVariant> results;
-        for (auto &key : pms.keys()) {
-            auto packageList = ids.values(key);
-            auto result = callback(key, list);
-            auto packageMap = result.data.toMap();
-            for (auto k : packageMap.keys()) {
-                results.insert(k, packageMap.value(k));
-            }
+        if (packageLists.isEmpty()) {
+            callback(PMResultOf<T>::warp(T()));
+            return;
+        }
+
+        // Backends run concurrently, results are merged as they complete.
+        auto results = QSharedPointer<PMResultOf<T>>::create(true, "", "", T());
+        auto pending = QSharedPointer<int>::create(packageLists.size());
+        const int backends = packageLists.size();
+        for (auto iter = packageLists.cbegin(); iter != packageLists.cend(); ++iter) {
+            const QString key = iter.key();
+            QElapsedTimer timer;
+            timer.start();
+            handler(key, iter.value(), [ = ](const PMResultOf<T> &result) {
+                recordBackend(*results, key, timer.elapsed(), result);
+                if (result.success) {
+                    for (auto iter = result.data.cbegin(); iter != result.data.cend(); ++iter) {
+                        results->data.insert(iter.key(), iter.value());
+                    }
+                }
+                for (auto k : result.errors.keys()) {
+                    results->errors.insert(k, result.errors.value(k));
+                }
+                if (--(*pending) == 0) {
+                    finishBackends(*results, backends);
+                    callback(*results);
+                }
+            });
         }
-        return results;
     }
 
-    PMResult run(const AppPackageList &apps, std::function<PMPackageHandler> callback)
+    void run(const AppPackageList &apps,
+             std::function<PMPackageHandler> handler,
+             PMAppCallback callback)
     {
         QList<Package> packages;
         for (const auto &v : apps) {
@@ -71,20 +168,20 @@ public:
             }
         }
 
-        auto results = mapRun(packages, callback);
-
-        QVariantMap appResults;
-        for (auto v : apps) {
-            QList<Package> packageResultList;
-            for (auto package : v.packages) {
-                auto packageResult = results.value(package.packageURI);
-                packageResultList.append(Package::fromVariantMap(packageResult.toMap()));
+        mapRun<PackageMap>(packages, handler,
+        [apps, callback](const PMPackageResult & results) {
+            AppPackageMap appResults;
+            for (auto v : apps) {
+                QList<Package> packageResultList;
+                for (auto package : v.packages) {
+                    packageResultList.append(results.data.value(package.packageURI()));
+                }
+                v.packages = packageResultList;
+                appResults.insert(v.name, v);
             }
-            v.packages = packageResultList;
-            appResults.insert(v.name, v.toVariantMap());
-        }
 
-        return PMResult::warp(appResults);
+            callback(results.withData(appResults));
+        });
     }
 
     QMap<QString, PackageManagerInterface *> pms;
@@ -118,7 +215,7 @@ void PackageManager::Open(const AppPackage &app)
         return;
     }
 
-    DpkURI dpk(app.packages.value(0).packageURI);
+    const DpkURI dpk = app.packages.value(0).dpk;
     auto pm = d->pms.value(dpk.getType());
     if (!pm) {
         qWarning() << "app package manager can not find!" << app.toVariantMap();
@@ -128,47 +225,51 @@ void PackageManager::Open(const AppPackage &app)
     pm->Open(dpk.getID());
 }
 
-PMResult PackageManager::Query(const AppPackageList &apps)
+void PackageManager::Query(const AppPackageList &apps, PMAppCallback callback)
 {
     Q_D(PackageManager);
-    return d->run(apps, [ & ](const QString & type, const QList<Package> &packages)-> PMResult {
-        return d->pms.value(type)->Query(packages);
-    });
+    d->run(apps, [d](const QString & type, const QList<Package> &packages, PMPackageCallback cb) {
+        d->pms.value(type)->Query(packages, cb);
+    }, callback);
 }
 
-PMResult PackageManager::QueryDownloadSize(const AppPackageList &apps)
+void PackageManager::QueryDownloadSize(const AppPackageList &apps, PMAppCallback callback)
 {
     Q_D(PackageManager);
-    return d->run(apps, [ & ](const QString & type, const QList<Package> &packages)-> PMResult {
-        return d->pms.value(type)->QueryDownloadSize(packages);
-    });
+    d->run(apps, [d](const QString & type, const QList<Package> &packages, PMPackageCallback cb) {
+        d->pms.value(type)->QueryDownloadSize(packages, cb);
+    }, callback);
 }
 
-PMResult PackageManager::Install(const AppPackageList &apps)
+void PackageManager::Install(const AppPackageList &apps, PMCallback callback)
 {
     Q_D(PackageManager);
     QList<Package> packages;
     for (const auto &v : apps) {
         for (auto package : v.packages) {
             packages.append(package);
-            qDebug() << package.packageURI << package.dpk.getID() << package.localName;
+            qDebug() << package.packageURI() << package.dpk.getID() << package.localName;
         }
     }
 
-    auto results = d->mapRun(packages,
-    [ & ](const QString & type, const QList<Package> &packages)-> PMResult {
-        return d->pms.value(type)->Install(packages);
-    });
-
-    QStringList paths;
-    for (auto v : results) {
-        paths << v.toString();
-    }
+    d->mapRun<JobPathMap>(packages,
+    [d](const QString & type, const QList<Package> &packages, PMJobCallback cb) {
+        d->pms.value(type)->Install(packages, cb);
+    },
+    [callback](const PMJobResult & results) {
+        // Packages of a batch share the same job.
+        QStringList paths;
+        for (auto v : results.data) {
+            if (!paths.contains(v)) {
+                paths << v;
+            }
+        }
 
-    return PMResult::warp(paths);
+        callback(results.withData(QVariant(paths)));
+    });
 }
 
-PMResult PackageManager::Remove(const AppPackageList &apps)
+void PackageManager::Remove(const AppPackageList &apps, PMCallback callback)
 {
 
     Q_D(PackageManager);
@@ -176,60 +277,80 @@ PMResult PackageManager::Remove(const AppPackageList &apps)
     for (const auto &v : apps) {
         for (auto package : v.packages) {
             packages.append(package);
-            qDebug() << package.packageURI << package.dpk.getID() << package.localName;
+            qDebug() << package.packageURI() << package.dpk.getID() << package.localName;
         }
     }
 
-    auto results = d->mapRun(packages,
-    [ & ](const QString & type, const QList<Package> &packages)-> PMResult {
-        return d->pms.value(type)->Remove(packages);
-    });
-
-    QStringList paths;
-    for (auto v : results) {
-        paths << v.toString();
-    }
+    d->mapRun<JobPathMap>(packages,
+    [d](const QString & type, const QList<Package> &packages, PMJobCallback cb) {
+        d->pms.value(type)->Remove(packages, cb);
+    },
+    [callback](const PMJobResult & results) {
+        // Packages of a batch share the same job.
+        QStringList paths;
+        for (auto v : results.data) {
+            if (!paths.contains(v)) {
+                paths << v;
+            }
+        }
 
-    return PMResult::warp(paths);
+        callback(results.withData(QVariant(paths)));
+    });
 }
 
 
-PMResult PackageManager::QueryVersion(const QStringList &dpks)
+void PackageManager::QueryVersion(const QStringList &dpks, PMCallback callback)
 {
     Q_D(PackageManager);
 
-    auto queryHandler = [ & ](const QString & key, const QStringList & idList) -> PMResult {
-//        return d->pms.value(key)->QueryVersion(idList);
-        Q_UNUSED(key);
-        Q_UNUSED(idList);
-
-        return PMResult::warp({});
+    auto queryHandler = [d](const QString & key, const QStringList & idList, PMCallback cb) {
+        QList<Package> packages;
+        for (auto &id : idList) {
+            Package package;
+            package.dpk = DpkURI("dpk://" + key + "/" + id);
+            packages.append(package);
+        }
+        d->pms.value(key)->QueryVersion(packages, cb);
     };
 
-    return  d->mergeRun(dpks, queryHandler);
+    d->mergeRun(dpks, queryHandler, callback);
 }
 
-PMResult PackageManager::QueryInstalledTime(const QStringList &dpks)
+void PackageManager::QueryInstalledTime(const QStringList &dpks, PMCallback callback)
 {
     Q_D(PackageManager);
-    auto queryHandler = [ & ](const QString & key, const QStringList & idList) -> PMResult {
-//        return d->pms.value(key)->QueryInstalledTime(idList);  Q_UNUSED(key);
+    auto queryHandler = [](const QString & key, const QStringList & idList, PMCallback cb) {
+//        d->pms.value(key)->QueryInstalledTime(idList, cb);
         Q_UNUSED(key);
         Q_UNUSED(idList);
-        return PMResult::warp({});
+        cb(PMResult::warp({}));
     };
 
-    return  d->mergeRun(dpks, queryHandler);
+    d->mergeRun(dpks, queryHandler, callback);
 }
 
-PMResult PackageManager::ListInstalled(const QStringList &packageID)
+void PackageManager::ListInstalled(const QStringList &packageID, PMCallback callback)
 {
     Q_D(PackageManager);
-    auto queryHandler = [ & ](const QString & key, const QStringList & idList) -> PMResult {
-        return d->pms.value(key)->ListInstalled(idList);
+    auto queryHandler = [d](const QString & key, const QStringList & idList, PMCallback cb) {
+        d->pms.value(key)->ListInstalled(idList, cb);
     };
 
-    return  d->mergeRun(packageID, queryHandler);
+    d->mergeRun(packageID, queryHandler, callback);
+}
+
+PMResult PackageManager::ListInstalledSnapshot()
+{
+    Q_D(PackageManager);
+    QVariantList pkgList;
+    for (auto pm : d->pms) {
+        auto result = pm->ListInstalledSnapshot();
+        if (!result.success) {
+            return result;
+        }
+        pkgList.append(result.data.toList());
+    }
+    return PMResult::warp(pkgList);
 }
 
 }
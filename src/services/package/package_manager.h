@@ -22,19 +22,21 @@ Q_SIGNALS:
 public Q_SLOTS:
     void Open(const AppPackage &app);
 
-    PMResult Query(const AppPackageList &apps);
+    void Query(const AppPackageList &apps, PMAppCallback callback);
 
-    PMResult QueryDownloadSize(const AppPackageList &apps);
+    void QueryDownloadSize(const AppPackageList &apps, PMAppCallback callback);
 
-    PMResult ListInstalled(const QStringList &packageID);
+    void ListInstalled(const QStringList &packageID, PMCallback callback);
 
-    PMResult Install(const AppPackageList &apps);
+    PMResult ListInstalledSnapshot();
 
-    PMResult Remove(const AppPackageList &apps);
+    void Install(const AppPackageList &apps, PMCallback callback);
+
+    void Remove(const AppPackageList &apps, PMCallback callback);
 
     //TODO remove
-    PMResult QueryVersion(const QStringList &packageID);
-    PMResult QueryInstalledTime(const QStringList &packageID);
+    void QueryVersion(const QStringList &packageID, PMCallback callback);
+    void QueryInstalledTime(const QStringList &packageID, PMCallback callback);
 
 private:
     QScopedPointer<PackageManagerPrivate> dd_ptr;
@@ -1,8 +1,86 @@
 #include "package_manager_interface.h"
 
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
 namespace dstore
 {
 
+namespace
+{
+
+// Unused entries of shared locale names are dropped each time the table
+// grows to twice its size after last pruning.
+const int kLocaleNamesMinPrune = 1024;
+
+bool SameLocaleNames(const LocaleNames &shared,
+                     const QMap<QString, QString> &names)
+{
+    if (shared.size() != names.size()) {
+        return false;
+    }
+    auto it = shared.constBegin();
+    for (auto name = names.constBegin(); name != names.constEnd(); ++name, ++it) {
+        if (it.key() != name.key() || it.value().toString() != name.value()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint LocaleNamesHash(const QMap<QString, QString> &names)
+{
+    uint hash = 0;
+    for (auto name = names.constBegin(); name != names.constEnd(); ++name) {
+        hash = hash * 31 + qHash(name.key());
+        hash = hash * 31 + qHash(name.value());
+    }
+    return hash;
+}
+
+}  // namespace
+
+LocaleNames SharedLocaleNames(const QMap<QString, QString> &names)
+{
+    if (names.isEmpty()) {
+        return LocaleNames();
+    }
+
+    static QMutex mutex;
+    // Keyed by hash of names, names with the same hash are compared one
+    // by one.
+    static QMultiHash<uint, LocaleNames> table;
+    static int prune_at = kLocaleNamesMinPrune;
+    const uint hash = LocaleNamesHash(names);
+    QMutexLocker locker(&mutex);
+    for (auto it = table.constFind(hash);
+            it != table.cend() && it.key() == hash; ++it) {
+        if (SameLocaleNames(it.value(), names)) {
+            return it.value();
+        }
+    }
+
+    if (table.size() >= prune_at) {
+        // Names only referenced by table are not used by any Package.
+        for (auto iter = table.begin(); iter != table.end();) {
+            if (iter.value().isDetached()) {
+                iter = table.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+        prune_at = qMax(kLocaleNamesMinPrune, table.size() * 2);
+    }
+
+    LocaleNames shared;
+    for (auto name = names.constBegin(); name != names.constEnd(); ++name) {
+        shared.insert(InternString(name.key()), name.value());
+    }
+    table.insert(hash, shared);
+    return shared;
+}
+
 PackageManagerInterface::PackageManagerInterface(QObject *parent) :
     QObject(parent)
 {
@@ -12,14 +90,13 @@ PackageManagerInterface::PackageManagerInterface(QObject *parent) :
 AppPackage AppPackage::fromVariantMap(const QVariantMap &json)
 {
     AppPackage app;
-    app.name = json.value("name").toString();
+    app.name = InternString(json.value("name").toString());
     app.localName = json.value("localName").toString();
     auto packages = json.value("packages").toList();
     for (const auto &v : packages) {
         Package pkg;
+        pkg.dpk = DpkURI(v.toMap().value("packageURI").toString());
         pkg.localName = app.localName;
-        pkg.packageURI = v.toMap().value("packageURI").toString();
-        pkg.dpk = DpkURI(pkg.packageURI);
         app.packages.append(pkg);
     }
 
@@ -32,7 +109,7 @@ QVariantMap AppPackage::toVariantMap() const
     obj.insert("name", name);
     obj.insert("localName", localName);
     QVariantList packagesList;
-    for (auto p : packages) {
+    for (const auto &p : packages) {
         packagesList.append(p.toVariantMap());
     }
     obj.insert("packages", packagesList);
@@ -42,7 +119,7 @@ QVariantMap AppPackage::toVariantMap() const
 Package Package::fromVariantMap(const QVariantMap &obj)
 {
     Package pkg;
-    pkg.packageURI = obj.value("packageURI").toString();
+    pkg.dpk = DpkURI(obj.value("packageURI").toString());
     pkg.packageName = obj.value("packageName").toString();
     pkg.appName = obj.value("appName").toString();
     pkg.localVersion = obj.value("localVersion").toString();
@@ -58,7 +135,7 @@ Package Package::fromVariantMap(const QVariantMap &obj)
 QVariantMap Package::toVariantMap() const
 {
     QVariantMap obj;
-    obj.insert("packageURI", packageURI);
+    obj.insert("packageURI", packageURI());
     obj.insert("packageName", packageName);
     obj.insert("appName", appName);
     obj.insert("localVersion", localVersion);
@@ -72,14 +149,4 @@ QVariantMap Package::toVariantMap() const
     return obj;
 }
 
-PMResult PMResult::warp(const QVariant &data)
-{
-    return PMResult(true, "", "", data);
-}
-
-PMResult PMResult::dbusError(const QDBusError &err)
-{
-    return PMResult(false, err.name(), err.message(), "");
-}
-
 }
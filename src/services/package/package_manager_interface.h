@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include <QMap>
 #include <QVariant>
 #include <QObject>
@@ -11,27 +13,39 @@
 namespace dstore
 {
 
+/*!
+ * \brief Localized names of a package, locale => name.
+ */
+typedef QVariantMap LocaleNames;
+
+/*!
+ * \brief Returns |names| from the shared table, so every Package with
+ * equal names holds one copy of them, even across arches and sources.
+ * Table entry is dropped once no Package uses it.
+ */
+LocaleNames SharedLocaleNames(const QMap<QString, QString> &names);
+
+/*!
+ * \brief Package is a value type, all members are implicitly shared or
+ * trivial, so it is cheap to copy and move in lists and maps.
+ */
 class Package
 {
 public:
-    ~Package()
+    QString packageURI() const
     {
-        installedTime = 0;
-        size = 0;
-        downloadSize = 0;
-        upgradable = false;
+        return dpk.toString();
     }
 
-    QString packageURI;
     QString packageName;
     QString appName;
     QString localVersion;
     QString remoteVersion;
-    qlonglong installedTime;
-    qlonglong size;
-    qlonglong downloadSize;
-    bool upgradable;
-    QMap<QString, QVariant> allLocalName;
+    qlonglong installedTime = 0;
+    qlonglong size = 0;
+    qlonglong downloadSize = 0;
+    // Shared by packages of equal names, see SharedLocaleNames().
+    LocaleNames allLocalName;
 
     static Package fromVariantMap(const QVariantMap &json);
     QVariantMap toVariantMap() const;
@@ -39,6 +53,7 @@ public:
 //private:
     QString localName;
     DpkURI dpk;
+    bool upgradable = false;
 };
 
 typedef QMap<QString, Package> PackageMap;
@@ -55,26 +70,102 @@ struct AppPackage {
 
 typedef QList<AppPackage> AppPackageList;
 
-struct PMResult {
-    PMResult(bool success,
-             QString errName,
-             QString errMsg,
-             QVariant data):
+/*!
+ * \brief Result of package manager request, carries typed |data| so that
+ * it is only serialized once at web channel boundary.
+ */
+template <typename T>
+struct PMResultOf {
+    PMResultOf(bool success,
+               QString errName,
+               QString errMsg,
+               T data):
         success(success), errName(errName), errMsg(errMsg), data(data)
     {
     }
 
-    static PMResult warp(const QVariant &data);
-    static PMResult dbusError(const QDBusError &err);
+    static PMResultOf warp(const T &data)
+    {
+        return PMResultOf(true, "", "", data);
+    }
+
+    static PMResultOf dbusError(const QDBusError &err)
+    {
+        return PMResultOf(false, err.name(), err.message(), T());
+    }
+
+    /*!
+     * \brief Result of a batch request, fails only if no package succeeded.
+     * \param data packageURI => package
+     * \param errors packageURI => { errorName, errorMsg }
+     */
+    static PMResultOf batch(const T &data, const QVariantMap &errors)
+    {
+        PMResultOf result = PMResultOf::warp(data);
+        result.errors = errors;
+        if (data.isEmpty() && !errors.isEmpty()) {
+            const auto err = errors.first().toMap();
+            result.success = false;
+            result.errName = err.value("errorName").toString();
+            result.errMsg = err.value("errorMsg").toString();
+        }
+        return result;
+    }
+
+    /*!
+     * \brief Same status, errors and latency as this result, with |data|.
+     */
+    template <typename U>
+    PMResultOf<U> withData(const U &data) const
+    {
+        PMResultOf<U> result(success, errName, errMsg, data);
+        result.errors = errors;
+        result.latency = latency;
+        result.backendErrors = backendErrors;
+        return result;
+    }
+
+    static QVariantMap packageError(const QDBusError &err)
+    {
+        return QVariantMap {
+            { "errorName", err.name() },
+            { "errorMsg", err.message() },
+        };
+    }
 
     bool success;
     QString errName;
     QString errMsg;
-    QVariant data;
+    T data;
+    // Errors of single packages in a batch request, keyed by packageURI.
+    QVariantMap errors;
+    // Time spent by each backend in milliseconds, keyed by backend type.
+    QVariantMap latency;
+    // Errors of failed backends, keyed by backend type.
+    QVariantMap backendErrors;
 };
 
+// packageURI => job path
+typedef QMap<QString, QString> JobPathMap;
+// app name => app
+typedef QMap<QString, AppPackage> AppPackageMap;
+
+typedef PMResultOf<QVariant> PMResult;
+typedef PMResultOf<PackageMap> PMPackageResult;
+typedef PMResultOf<JobPathMap> PMJobResult;
+typedef PMResultOf<AppPackageMap> PMAppResult;
+
 typedef QMap<QString, PMResult> PMResultMap;
 
+/*!
+ * \brief Continuation invoked once a package manager request is finished.
+ * It is always called in the thread which owns the package manager.
+ */
+typedef std::function<void(const PMResult &)> PMCallback;
+typedef std::function<void(const PMPackageResult &)> PMPackageCallback;
+typedef std::function<void(const PMJobResult &)> PMJobCallback;
+typedef std::function<void(const PMAppResult &)> PMAppCallback;
+
 class PackageManagerInterface : public QObject
 {
     Q_OBJECT
@@ -90,37 +181,42 @@ public Q_SLOTS:
     /*!
      * \brief Query
      */
-    virtual PMResult Query(const QList<Package> &packageIDs) = 0;
+    virtual void Query(const QList<Package> &packageIDs, PMPackageCallback callback) = 0;
 
     /*!
      * \brief QueryDownloadSize
      */
-    virtual PMResult QueryDownloadSize(const QList<Package> &packageIDs) = 0;
+    virtual void QueryDownloadSize(const QList<Package> &packageIDs, PMPackageCallback callback) = 0;
 
-    virtual PMResult QueryVersion(const QList<Package> &packageIDs) = 0;
+    virtual void QueryVersion(const QList<Package> &packageIDs, PMCallback callback) = 0;
 
     /*!
      * \brief QueryRemote
      */
-    virtual PMResult QueryInstalledTime(const QList<Package> &packageIDs) = 0;
+    virtual void QueryInstalledTime(const QList<Package> &packageIDs, PMCallback callback) = 0;
 
     /*!
      * \brief ListInstalled
-     * \return
      */
-    virtual PMResult ListInstalled(const QList<QString> &packageIDs) = 0;
+    virtual void ListInstalled(const QList<QString> &packageIDs, PMCallback callback) = 0;
+
+    /*!
+     * \brief ListInstalledSnapshot returns installed packages saved on disk
+     * by last ListInstalled() call, which might be outdated.
+     */
+    virtual PMResult ListInstalledSnapshot() = 0;
 
     /*!
-     * \brief Async install package, return immediately.
+     * \brief Async install package, callback receives job paths.
      * \param packageIDList
      */
-    virtual PMResult Install(const QList<Package> &packageIDList) = 0;
+    virtual void Install(const QList<Package> &packageIDList, PMJobCallback callback) = 0;
 
     /*!
      * \brief Remove
      * \param packageIDList
      */
-    virtual PMResult Remove(const QList<Package> &packageIDList) = 0;
+    virtual void Remove(const QList<Package> &packageIDList, PMJobCallback callback) = 0;
 };
 
 }
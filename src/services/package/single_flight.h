@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <QDBusError>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+
+namespace dstore
+{
+
+/*!
+ * \brief Shares one pending backend request between concurrent callers
+ * asking for the same package, every caller gets its own result.
+ * Flights and results are keyed by requested ids as is, so that
+ * "foo:amd64" and "foo:i386" are fetched separately.
+ */
+template <typename T>
+class SingleFlight
+{
+public:
+    // Values are keyed by requested id.
+    typedef QMap<QString, T> ValueMap;
+    typedef std::function<void(const QDBusError &, const ValueMap &)> Callback;
+    typedef std::function<void(const QStringList &, Callback)> Fetch;
+
+    /*!
+     * \brief Call |fetch| only for |ids| not in flight, |callback| is called
+     * once all of |ids| are replied.
+     */
+    void run(const QStringList &ids, Fetch fetch, Callback callback)
+    {
+        const QStringList keys = ids.toSet().toList();
+        if (keys.isEmpty()) {
+            callback(QDBusError(), ValueMap());
+            return;
+        }
+
+        struct Join {
+            int pending = 0;
+            QDBusError error;
+            ValueMap values;
+        };
+        auto join = QSharedPointer<Join>::create();
+        join->pending = keys.size();
+        auto waiter = [join, callback](const QString & key,
+                                       const QDBusError & error,
+                                       const ValueMap & values) {
+            if (error.isValid()) {
+                join->error = error;
+            } else if (values.contains(key)) {
+                join->values.insert(key, values.value(key));
+            }
+            if (--join->pending == 0) {
+                callback(join->error, join->values);
+            }
+        };
+
+        QStringList missing;
+        for (auto &key : keys) {
+            if (!flights_->contains(key)) {
+                missing << key;
+            }
+            (*flights_)[key].append(waiter);
+        }
+        if (missing.isEmpty()) {
+            return;
+        }
+
+        // Reply might arrive after owner of flights is destroyed.
+        const QWeakPointer<FlightMap> weak_flights = flights_;
+        fetch(missing, [weak_flights, missing](const QDBusError & error,
+                                               const ValueMap & values) {
+            const QSharedPointer<FlightMap> flights = weak_flights.toStrongRef();
+            if (flights.isNull()) {
+                return;
+            }
+            for (auto &key : missing) {
+                for (auto &w : flights->take(key)) {
+                    w(key, error, values);
+                }
+            }
+        });
+    }
+
+private:
+    typedef std::function<void(const QString &, const QDBusError &, const ValueMap &)> Waiter;
+    typedef QHash<QString, QList<Waiter>> FlightMap;
+    QSharedPointer<FlightMap> flights_ = QSharedPointer<FlightMap>::create();
+};
+
+}  // namespace dstore
@@ -17,8 +17,17 @@
 
 #include "services/store_daemon_manager.h"
 
+#include <algorithm>
+
+#include <QDBusPendingCallWatcher>
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
 #include <QThread>
+#include <QTimer>
+#include <QVector>
 
+#include "dbus/dbus_call_stats.h"
 #include "dbus/dbus_consts.h"
 #include "dbus/dbus_variant/app_version.h"
 #include "dbus/dbus_variant/installed_app_info.h"
@@ -26,8 +35,10 @@
 #include "dbus/lastore_deb_interface.h"
 #include "dbus/lastore_job_interface.h"
 
+#include "services/job_registry.h"
 #include "package/package_manager.h"
 #include "package/apt_package_manager.h"
+#include "package/deb_version.h"
 
 namespace dstore
 {
@@ -39,30 +50,74 @@ const char kResultErrName[] = "errorName";
 const char kResultErrMsg[] = "errorMsg";
 const char kResult[] = "result";
 const char kResultName[] = "name";
+const char kResultErrors[] = "errors";
+const char kResultVersion[] = "version";
+const char kResultLatency[] = "latency";
+const char kResultBackendErrors[] = "backendErrors";
+const char kErrInvalidJob[] = "Invalid job interface";
+const char kErrCancelled[] = "Request cancelled";
+
+const char kProjectionFields[] = "fields";
+const char kProjectionLocale[] = "locale";
+const char kPackageAllLocalName[] = "allLocalName";
+const char kPackageLocalName[] = "localName";
+const char kPackageName[] = "packageName";
+const char kPackageAppName[] = "appName";
+const char kPackages[] = "packages";
+const char kFallbackLocale[] = "en_US";
+const char kPageOffset[] = "offset";
+const char kPageLimit[] = "limit";
+const char kPageSort[] = "sort";
+const char kPageOrder[] = "order";
+const char kPageOrderDesc[] = "desc";
+const char kPageTotal[] = "total";
+
+// Bursts of job list changes are merged into one notification.
+const int kJobListDebounce = 100;
+
+// Job updates are pushed at most once per millisecond.
+const int kJobsUpdateMaxRate = 1000;
 
-bool ReadJobInfo(LastoreJobInterface &job_interface,
+// Reconciling snapshot with backend is retried with growing delay if
+// backend is not ready yet.
+const int kInstalledRetryDelay = 2000;
+const int kInstalledMaxRetries = 5;
+
+// Convert cached job properties to job info.
+bool ReadJobInfo(const QVariantMap &props,
                  const QString &job,
                  QVariantMap &result)
 {
-    result.insert("id", job_interface.id());
+    const QStringList pkgs = props.value("Packages").toStringList();
+    result.insert("id", props.value("Id").toString());
     result.insert("job", job);
-    result.insert("status", job_interface.status());
-    result.insert("type", job_interface.type());
-    result.insert("speed", job_interface.speed());
-    result.insert("progress", job_interface.progress());
-    result.insert("description", job_interface.description());
-    result.insert("packages", job_interface.packages());
-    result.insert("cancelable", job_interface.cancelable());
-    result.insert("downloadSize", job_interface.downloadSize());
-    result.insert("createTime", job_interface.createTime());
-    result.insert("name", job_interface.name());
+    result.insert("status", props.value("Status").toString());
+    result.insert("type", props.value("Type").toString());
+    result.insert("speed", props.value("Speed").toLongLong());
+    result.insert("progress", props.value("Progress").toDouble());
+    result.insert("description", props.value("Description").toString());
+    result.insert("packages", pkgs);
+    result.insert("cancelable", props.value("Cancelable").toBool());
+    result.insert("downloadSize", props.value("DownloadSize").toLongLong());
+    result.insert("createTime", props.value("CreateTime").toLongLong());
+    result.insert("name", props.value("Name").toString());
     QStringList app_names;
 
+    // Batch job reports status of each requested package.
+    const QVariantMap package_status = props.value("PackageStatus").toMap();
+    if (!package_status.isEmpty()) {
+        result.insert("packageStatus", package_status);
+        for (const QString &package_name : package_status.keys()) {
+            app_names.append(PackageIDFromName(package_name));
+        }
+        result.insert("names", app_names);
+        return true;
+    }
+
     // Package list may container additional language related packages.
-    const QStringList pkgs = job_interface.packages();
     if (pkgs.length() >= 1) {
         const QString &package_name = pkgs.at(0);
-        auto packageID =  package_name.split(":").first();
+        auto packageID = PackageIDFromName(package_name);
         app_names.append(packageID);
     }
 
@@ -70,6 +125,290 @@ bool ReadJobInfo(LastoreJobInterface &job_interface,
 
     return (!app_names.isEmpty());
 }
+
+// Reply to request on a job path which is not in job list.
+QVariantMap InvalidJobReply(const QString &job)
+{
+    return QVariantMap {
+        { kResultOk, false },
+        { kResultErrName, kErrInvalidJob },
+        { kResultErrMsg, "" },
+        { kResult, job },
+    };
+}
+
+bool IsCancelled(const StoreDaemonManager::CancelCheck &cancelled)
+{
+    return cancelled && cancelled();
+}
+
+// Reply to request cancelled by caller, it is dropped by caller anyway.
+QVariantMap CancelledReply()
+{
+    return QVariantMap {
+        { kResultOk, false },
+        { kResultErrName, kErrCancelled },
+        { kResultErrMsg, "" },
+    };
+}
+
+// Reply to job control call on |job|, failed if |error| is valid.
+QVariantMap JobControlReply(const QString &job, const QDBusError &error)
+{
+    return QVariantMap {
+        { kResultOk, !error.isValid() },
+        { kResultErrName, error.name() },
+        { kResultErrMsg, error.message() },
+        { kResult, job },
+    };
+}
+
+QVariantMap JobListReply(const QStringList &paths)
+{
+    return QVariantMap {
+        { kResultOk, true },
+        { kResultErrName, "" },
+        { kResultErrMsg, "" },
+        { kResult, paths },
+    };
+}
+
+QVariantMap ToReply(const PMResult &result)
+{
+    QVariantMap reply {
+        { kResultOk, result.success },
+        { kResultErrName, result.errName },
+        { kResultErrMsg, result.errMsg },
+        { kResult, result.data},
+    };
+    if (!result.errors.isEmpty()) {
+        reply.insert(kResultErrors, result.errors);
+    }
+    if (!result.latency.isEmpty()) {
+        reply.insert(kResultLatency, result.latency);
+    }
+    if (!result.backendErrors.isEmpty()) {
+        reply.insert(kResultBackendErrors, result.backendErrors);
+    }
+    return reply;
+}
+
+// Serialize typed result for web page.
+QVariantMap ToReply(const PMAppResult &result)
+{
+    QVariantMap apps;
+    for (auto iter = result.data.cbegin(); iter != result.data.cend(); ++iter) {
+        apps.insert(iter.key(), iter.value().toVariantMap());
+    }
+    PMResult reply(result.success, result.errName, result.errMsg, apps);
+    reply.errors = result.errors;
+    reply.latency = result.latency;
+    reply.backendErrors = result.backendErrors;
+    return ToReply(reply);
+}
+
+// Key of job info is property name in lower camel case.
+QString JobInfoKey(const QString &property)
+{
+    QString key = property;
+    if (!key.isEmpty()) {
+        key[0] = key[0].toLower();
+    }
+    return key;
+}
+
+QStringList ToJobPaths(const QList<QDBusObjectPath> &jobs)
+{
+    QStringList paths;
+    for (const QDBusObjectPath &job : jobs) {
+        paths.append(job.path());
+    }
+    return paths;
+}
+
+/**
+ * Fields and locale of packages requested by web page, so that unused
+ * fields and translations are not sent over web channel.
+ */
+struct Projection {
+    explicit Projection(const QVariantMap &projection) :
+        fields(projection.value(kProjectionFields).toStringList()),
+        locale(projection.value(kProjectionLocale).toString())
+    {
+    }
+
+    bool isEmpty() const
+    {
+        return fields.isEmpty() && locale.isEmpty();
+    }
+
+    // Identifies projection in cache.
+    QString key() const
+    {
+        return locale + "|" + fields.join(",");
+    }
+
+    QVariantMap package(const QVariantMap &pkg) const
+    {
+        QVariantMap result;
+        if (fields.isEmpty()) {
+            result = pkg;
+        } else {
+            for (const QString &field : fields) {
+                auto iter = pkg.constFind(field);
+                if (iter != pkg.constEnd()) {
+                    result.insert(field, iter.value());
+                }
+            }
+        }
+
+        if (!locale.isEmpty()) {
+            result.remove(kPackageAllLocalName);
+            if (fields.isEmpty() || fields.contains(kPackageLocalName)) {
+                result.insert(kPackageLocalName, localName(pkg));
+            }
+        }
+        return result;
+    }
+
+    QVariantList packages(const QVariantList &list) const
+    {
+        QVariantList result;
+        result.reserve(list.size());
+        for (const QVariant &pkg : list) {
+            result.append(this->package(pkg.toMap()));
+        }
+        return result;
+    }
+
+    // Project packages in result of a request, leaving other fields as is.
+    QVariantMap installedReply(const QVariantMap &reply) const
+    {
+        if (!reply.contains(kResult)) {
+            return reply;
+        }
+        QVariantMap result = reply;
+        result.insert(kResult, this->packages(reply.value(kResult).toList()));
+        return result;
+    }
+
+    QVariantMap queryReply(const QVariantMap &reply) const
+    {
+        QVariantMap apps = reply.value(kResult).toMap();
+        for (auto iter = apps.begin(); iter != apps.end(); ++iter) {
+            QVariantMap app = iter.value().toMap();
+            app.insert(kPackages, this->packages(app.value(kPackages).toList()));
+            iter.value() = app;
+        }
+        QVariantMap result = reply;
+        result.insert(kResult, apps);
+        return result;
+    }
+
+    // Value of |field| in projected |pkg|, read without projecting it.
+    QVariant value(const QVariantMap &pkg, const QString &field) const
+    {
+        if (field == kPackageLocalName && !locale.isEmpty()) {
+            return localName(pkg);
+        }
+        return pkg.value(field);
+    }
+
+    QStringList fields;
+    QString locale;
+
+private:
+    // Name in locale, falls back to English and then package name.
+    QString localName(const QVariantMap &pkg) const
+    {
+        const QVariantMap names = pkg.value(kPackageAllLocalName).toMap();
+        QString name = names.value(locale).toString();
+        if (name.isEmpty()) {
+            name = names.value(kFallbackLocale).toString();
+        }
+        if (name.isEmpty()) {
+            name = pkg.value(kPackageLocalName).toString();
+        }
+        if (name.isEmpty()) {
+            name = pkg.value(kPackageName).toString();
+        }
+        return name;
+    }
+};
+
+/**
+ * Range and order of installed packages requested by web page.
+ */
+struct PageRequest {
+    explicit PageRequest(const QVariantMap &page) :
+        offset(qMax(0, page.value(kPageOffset).toInt())),
+        limit(qMax(0, page.value(kPageLimit).toInt())),
+        sort(page.value(kPageSort).toString()),
+        descending(page.value(kPageOrder).toString() == kPageOrderDesc)
+    {
+    }
+
+    // Identifies sort order in cache.
+    QString key() const
+    {
+        return sort + (descending ? "-" : "+");
+    }
+
+    bool lessThan(const QVariant &a, const QVariant &b) const
+    {
+        if (a.type() == QVariant::String || b.type() == QVariant::String) {
+            return QString::localeAwareCompare(a.toString(), b.toString()) < 0;
+        }
+        return a.toLongLong() < b.toLongLong();
+    }
+
+    // Stable sort of unprojected packages by |sort| field, as it would be
+    // returned by |projection|, so any field can be sorted on.
+    QVariantList sorted(const QVariantList &list,
+                        const Projection &projection) const
+    {
+        if (sort.isEmpty()) {
+            return list;
+        }
+
+        QVector<QPair<QVariant, int>> keys;
+        keys.reserve(list.size());
+        for (int i = 0; i < list.size(); ++i) {
+            keys.append(qMakePair(projection.value(list.at(i).toMap(), sort), i));
+        }
+        std::stable_sort(keys.begin(), keys.end(),
+        [this](const QPair<QVariant, int> &a, const QPair<QVariant, int> &b) {
+            return descending ? lessThan(b.first, a.first) : lessThan(a.first, b.first);
+        });
+
+        QVariantList result;
+        result.reserve(list.size());
+        for (const auto &key : keys) {
+            result.append(list.at(key.second));
+        }
+        return result;
+    }
+
+    QVariantList slice(const QVariantList &list) const
+    {
+        return list.mid(offset, limit > 0 ? limit : -1);
+    }
+
+    int offset;
+    int limit;
+    QString sort;
+    bool descending;
+};
+
+AppPackageList ToAppPackageList(const QVariantList &apps)
+{
+    AppPackageList list;
+    for (auto v : apps) {
+        list.append(AppPackage::fromVariantMap(v.toMap()));
+    }
+    return list;
+}
+
 }
 
 class StoreDaemonManagerPrivate
@@ -81,8 +420,14 @@ public:
                            kLastoreDebDbusPath,
                            QDBusConnection::sessionBus(),
                            parent)),
+        job_registry_(new JobRegistry(parent)),
+        jobs_update_timer_(new QTimer(parent)),
+        job_list_timer_(new QTimer(parent)),
         q_ptr(parent)
     {
+        jobs_update_timer_->setSingleShot(true);
+        job_list_timer_->setSingleShot(true);
+        job_list_timer_->setInterval(kJobListDebounce);
         auto aptPM = new AptPackageManager(parent);
         pm = new PackageManager(parent);
         pm->registerDpk("deb", aptPM);
@@ -92,12 +437,110 @@ public:
 
     void initConnections();
 
+    /**
+     * Serve installed package list from cache, or load it if it is not ready.
+     */
+    void getInstalled(StoreDaemonManager::ReplyCallback callback);
+
+    /**
+     * Mark installed package list as outdated, reload it if it is in use.
+     */
+    void invalidateInstalled();
+
+    /**
+     * Serve installed package list trimmed to |projection|, cached until
+     * installed list or projection changes.
+     */
+    void getInstalledProjected(const Projection &projection,
+                               StoreDaemonManager::ReplyCallback callback,
+                               StoreDaemonManager::CancelCheck cancelled);
+
+    void loadInstalled();
+
+    /**
+     * Read installed package list saved on disk by last session.
+     */
+    void loadSnapshot();
+
+    /**
+     * Collect changed fields of |path| until next jobsUpdated() signal.
+     */
+    void onJobChanged(const QString &path, const QVariantMap &changed);
+
+    void flushJobUpdates();
+
+    /**
+     * Update job list with value pushed by backend.
+     */
+    void onJobListChanged(const QStringList &paths);
+
+    /**
+     * Emit difference between job list and the one emitted last time.
+     */
+    void flushJobList();
+
+    /**
+     * Read JobList property once, if backend has not pushed it yet.
+     */
+    void loadJobList();
+
+    typedef std::function<QDBusPendingCall(LastoreJobInterface *)> JobCall;
+
+    /**
+     * Issue job control |call| on |job|, reply once backend returns.
+     */
+    void controlJob(const QString &job, JobCall call,
+                    StoreDaemonManager::ReplyCallback callback);
 
     PackageManager      *pm = nullptr;
     LastoreDebInterface *deb_interface_ = nullptr;
+    JobRegistry *job_registry_ = nullptr;
+
+    // Job changes are coalesced and pushed at most jobs_update_rate_
+    // times per second.
+    QTimer *jobs_update_timer_ = nullptr;
+    int jobs_update_rate_ = 0;
+    QVariantMap pending_job_updates_;
 
     QMap<QString, QString> apps;
 
+    // Installed packages are only changed when a job finishes,
+    // cache them and reload on job list changes.
+    QVariantMap installed_reply_;
+    bool installed_valid_ = false;
+    bool installed_loading_ = false;
+    bool installed_reload_ = false;
+    // installed_reply_ holds snapshot from disk, not yet reconciled.
+    bool installed_snapshot_ = false;
+    // Snapshot is read at most once, even if it is missing.
+    bool installed_snapshot_tried_ = false;
+    int installed_retries_ = 0;
+    qlonglong installed_version_ = 0;
+    QList<StoreDaemonManager::ReplyCallback> installed_waiters_;
+
+    // Last projected installed package list, pages usually ask for the
+    // same projection repeatedly.
+    QVariantMap installed_projected_reply_;
+    QString installed_projection_;
+    qlonglong installed_projected_version_ = -1;
+
+    // Installed packages sorted for last page request.
+    QVariantList installed_sorted_;
+    QString installed_sort_key_;
+    qlonglong installed_sorted_version_ = -1;
+
+    // app name => installed version, for upgradablePackages().
+    QHash<QString, QString> installed_versions_;
+    qlonglong installed_versions_version_ = -1;
+
+    // Latest job list, and the one emitted in last jobListChanged().
+    QStringList job_list_;
+    bool job_list_valid_ = false;
+    bool job_list_loading_ = false;
+    QList<StoreDaemonManager::ReplyCallback> job_list_waiters_;
+    QStringList jobs_;
+    QTimer *job_list_timer_ = nullptr;
+
     StoreDaemonManager *q_ptr;
     Q_DECLARE_PUBLIC(StoreDaemonManager)
 };
@@ -105,8 +548,301 @@ public:
 void StoreDaemonManagerPrivate::initConnections()
 {
     Q_Q(StoreDaemonManager);
-    q->connect(deb_interface_, &LastoreDebInterface::jobListChanged,
-               q, &StoreDaemonManager::onJobListChanged);
+    // Read job list from signal, instead of querying JobList property.
+    q->connect(deb_interface_, &LastoreDebInterface::propertiesChanged,
+    q, [this](const QVariantMap & changed) {
+        if (changed.contains("JobList")) {
+            this->onJobListChanged(ToJobPaths(
+                qdbus_cast<QList<QDBusObjectPath>>(changed.value("JobList"))));
+        }
+    });
+    q->connect(job_list_timer_, &QTimer::timeout, q, [this]() {
+        this->flushJobList();
+    });
+    q->connect(job_registry_, &JobRegistry::jobChanged,
+    q, [this](const QString & path, const QVariantMap & changed) {
+        this->onJobChanged(path, changed);
+    });
+    q->connect(jobs_update_timer_, &QTimer::timeout, q, [this]() {
+        this->flushJobUpdates();
+    });
+}
+
+void StoreDaemonManagerPrivate::onJobChanged(const QString &path,
+                                             const QVariantMap &changed)
+{
+    if (jobs_update_rate_ <= 0) {
+        return;
+    }
+
+    QVariantMap fields = pending_job_updates_.value(path).toMap();
+    for (auto iter = changed.cbegin(); iter != changed.cend(); ++iter) {
+        fields.insert(JobInfoKey(iter.key()), iter.value());
+    }
+    pending_job_updates_.insert(path, fields);
+
+    if (!jobs_update_timer_->isActive()) {
+        jobs_update_timer_->start(qMax(1000 / jobs_update_rate_, 1));
+    }
+}
+
+void StoreDaemonManagerPrivate::onJobListChanged(const QStringList &paths)
+{
+    job_list_ = paths;
+    job_list_valid_ = true;
+    job_list_timer_->start();
+}
+
+void StoreDaemonManagerPrivate::flushJobList()
+{
+    Q_Q(StoreDaemonManager);
+    QStringList added;
+    for (const QString &job : job_list_) {
+        if (!jobs_.contains(job)) {
+            added.append(job);
+        }
+    }
+    QStringList removed;
+    for (const QString &job : jobs_) {
+        if (!job_list_.contains(job)) {
+            removed.append(job);
+        }
+    }
+    if (added.isEmpty() && removed.isEmpty()) {
+        return;
+    }
+
+    // A job is removed from list when it is finished, which might have
+    // installed or removed some packages.
+    if (!removed.isEmpty()) {
+        this->invalidateInstalled();
+    }
+    jobs_ = job_list_;
+    job_registry_->sync(jobs_);
+
+    if (!removed.isEmpty()) {
+        emit q->jobsRemoved(removed);
+    }
+    if (!added.isEmpty()) {
+        emit q->jobsAdded(added);
+    }
+    emit q->jobListChanged(jobs_);
+}
+
+void StoreDaemonManagerPrivate::flushJobUpdates()
+{
+    Q_Q(StoreDaemonManager);
+    if (pending_job_updates_.isEmpty()) {
+        return;
+    }
+    const QVariantMap jobs = pending_job_updates_;
+    pending_job_updates_.clear();
+    emit q->jobsUpdated(jobs);
+}
+
+void StoreDaemonManagerPrivate::loadJobList()
+{
+    Q_Q(StoreDaemonManager);
+    if (job_list_loading_) {
+        return;
+    }
+    job_list_loading_ = true;
+
+    auto watcher = new QDBusPendingCallWatcher(
+        TimedGetProperty(deb_interface_, "JobList"), q);
+    q->connect(watcher, &QDBusPendingCallWatcher::finished,
+    q, [this](QDBusPendingCallWatcher * w) {
+        w->deleteLater();
+        job_list_loading_ = false;
+        const QDBusPendingReply<QDBusVariant> reply = *w;
+        if (reply.isError()) {
+            qWarning() << reply.error();
+        } else if (!job_list_valid_) {
+            // List pushed by backend meanwhile is newer than reply.
+            job_list_ = ToJobPaths(qdbus_cast<QList<QDBusObjectPath>>(
+                                       reply.value().variant()));
+            job_list_valid_ = true;
+            jobs_ = job_list_;
+            job_registry_->sync(jobs_);
+        }
+
+        const QList<StoreDaemonManager::ReplyCallback> waiters = job_list_waiters_;
+        job_list_waiters_.clear();
+        const QVariantMap result = job_list_valid_ ?
+                                   JobListReply(job_registry_->paths()) :
+                                   QVariantMap {
+            { kResultOk, false },
+            { kResultErrName, reply.error().name() },
+            { kResultErrMsg, reply.error().message() },
+        };
+        for (auto &waiter : waiters) {
+            waiter(result);
+        }
+    });
+}
+
+void StoreDaemonManagerPrivate::controlJob(const QString &job,
+                                           JobCall call,
+                                           StoreDaemonManager::ReplyCallback callback)
+{
+    Q_Q(StoreDaemonManager);
+    LastoreJobInterface *job_interface = job_registry_->job(job);
+    if (job_interface == nullptr) {
+        callback(InvalidJobReply(job));
+        return;
+    }
+    if (!job_interface->isValid()) {
+        callback(JobControlReply(job, job_interface->lastError()));
+        return;
+    }
+
+    auto watcher = new QDBusPendingCallWatcher(call(job_interface), q);
+    q->connect(watcher, &QDBusPendingCallWatcher::finished,
+    q, [job, callback](QDBusPendingCallWatcher * w) {
+        w->deleteLater();
+        callback(JobControlReply(job, w->error()));
+    });
+}
+
+void StoreDaemonManagerPrivate::getInstalled(StoreDaemonManager::ReplyCallback callback)
+{
+    if (installed_valid_) {
+        callback(installed_reply_);
+        return;
+    }
+
+    // On cold start, serve the snapshot saved by last session at once
+    // and reconcile it with backend in background.
+    if (!installed_snapshot_tried_ && installed_version_ == 0 &&
+            !installed_loading_) {
+        this->loadSnapshot();
+    }
+    if (installed_snapshot_) {
+        callback(installed_reply_);
+        if (!installed_loading_) {
+            this->loadInstalled();
+        }
+        return;
+    }
+
+    installed_waiters_.append(callback);
+    if (!installed_loading_) {
+        this->loadInstalled();
+    }
+}
+
+void StoreDaemonManagerPrivate::getInstalledProjected(
+    const Projection &projection,
+    StoreDaemonManager::ReplyCallback callback,
+    StoreDaemonManager::CancelCheck cancelled)
+{
+    if (projection.isEmpty()) {
+        this->getInstalled(callback);
+        return;
+    }
+
+    this->getInstalled([this, projection, callback, cancelled](const QVariantMap & reply) {
+        if (IsCancelled(cancelled)) {
+            callback(CancelledReply());
+            return;
+        }
+        const qlonglong version = reply.value(kResultVersion, -1).toLongLong();
+        if (!reply.value(kResultOk).toBool() || version < 0) {
+            callback(projection.installedReply(reply));
+            return;
+        }
+        if (version != installed_projected_version_ ||
+                projection.key() != installed_projection_) {
+            installed_projected_reply_ = projection.installedReply(reply);
+            installed_projected_version_ = version;
+            installed_projection_ = projection.key();
+        }
+        callback(installed_projected_reply_);
+    });
+}
+
+void StoreDaemonManagerPrivate::invalidateInstalled()
+{
+    // Nobody has asked for installed list yet.
+    if (!installed_valid_ && !installed_loading_) {
+        return;
+    }
+
+    installed_valid_ = false;
+    if (installed_loading_) {
+        // Result of pending request might be outdated.
+        installed_reload_ = true;
+    } else {
+        this->loadInstalled();
+    }
+}
+
+void StoreDaemonManagerPrivate::loadInstalled()
+{
+    Q_Q(StoreDaemonManager);
+    installed_loading_ = true;
+    installed_reload_ = false;
+    // TODO: filter install list
+    pm->ListInstalled(/*apps.keys()*/{}, [this, q](const PMResult & result) {
+        installed_loading_ = false;
+        if (installed_reload_) {
+            this->loadInstalled();
+            return;
+        }
+
+        QVariantMap reply = ToReply(result);
+        bool changed = false;
+        // Failed or partial list is never cached, next request loads it
+        // again.
+        if (result.success && result.backendErrors.isEmpty()) {
+            // Keep version of snapshot if nothing changed since last session.
+            changed = !(installed_snapshot_ &&
+                        installed_reply_.value(kResult) == result.data);
+            if (changed) {
+                installed_version_++;
+            }
+            reply.insert(kResultVersion, installed_version_);
+            installed_reply_ = reply;
+            installed_valid_ = true;
+            installed_snapshot_ = false;
+            installed_retries_ = 0;
+        } else if (installed_snapshot_ &&
+                   installed_retries_ < kInstalledMaxRetries) {
+            // Keep serving snapshot, which is only replaced by a list
+            // loaded from backend.
+            installed_retries_++;
+            QTimer::singleShot(kInstalledRetryDelay * installed_retries_, q,
+            [this]() {
+                if (installed_snapshot_ && !installed_loading_) {
+                    this->loadInstalled();
+                }
+            });
+        }
+
+        const auto waiters = installed_waiters_;
+        installed_waiters_.clear();
+        for (auto &waiter : waiters) {
+            waiter(reply);
+        }
+
+        if (changed) {
+            emit q->installedPackagesChanged(installed_version_);
+        }
+    });
+}
+
+void StoreDaemonManagerPrivate::loadSnapshot()
+{
+    installed_snapshot_tried_ = true;
+    const PMResult result = pm->ListInstalledSnapshot();
+    if (!result.success || result.data.toList().isEmpty()) {
+        return;
+    }
+
+    installed_version_++;
+    installed_reply_ = ToReply(result);
+    installed_reply_.insert(kResultVersion, installed_version_);
+    installed_snapshot_ = true;
 }
 
 StoreDaemonManager::StoreDaemonManager(QObject *parent)
@@ -154,298 +890,343 @@ bool StoreDaemonManager::isDBusConnected()
     return  d->deb_interface_->isValid();
 }
 
-QVariantMap StoreDaemonManager::cleanJob(const QString &job)
+void StoreDaemonManager::cleanJob(const QString &job, ReplyCallback callback)
 {
-    LastoreJobInterface job_interface(kLastoreDebJobService,
-                                      job,
-                                      QDBusConnection::sessionBus(),
-                                      this);
-    if (job_interface.isValid()) {
-        const QDBusPendingReply<> reply = job_interface.Clean();
-        if (reply.isError()) {
-            return QVariantMap {
-                { kResultOk, false },
-                { kResultErrName, reply.error().name() },
-                { kResultErrMsg, reply.error().message() },
-                { kResult, job}
-            };
-        } else {
-            return QVariantMap {
-                { kResultOk, true },
-                { kResultErrName, "" },
-                { kResultErrMsg, "" },
-                { kResult, job}
-            };
-        }
-    } else {
-        return QVariantMap {
-            { kResultOk, false },
-            { kResultErrName, job_interface.lastError().name() },
-            { kResultErrMsg, job_interface.lastError().message() },
-        };
-    }
+    Q_D(StoreDaemonManager);
+    d->controlJob(job, [](LastoreJobInterface * job_interface) {
+        return job_interface->Clean();
+    }, callback);
 }
 
-QVariantMap StoreDaemonManager::pauseJob(const QString &job)
+void StoreDaemonManager::pauseJob(const QString &job, ReplyCallback callback)
 {
-    LastoreJobInterface job_interface(kLastoreDebJobService,
-                                      job,
-                                      QDBusConnection::sessionBus(),
-                                      this);
-    if (job_interface.isValid()) {
-        const QDBusPendingReply<> reply = job_interface.Pause();
-        if (reply.isError()) {
-            return QVariantMap {
-                { kResultOk, false },
-                { kResultErrName, reply.error().name() },
-                { kResultErrMsg, reply.error().message() },
-                { kResult, job}
-            };
-        } else {
-            return QVariantMap {
-                { kResultOk, true },
-                { kResultErrName, "" },
-                { kResultErrMsg, "" },
-                { kResult, job}
-            };
-        }
-    } else {
-        return QVariantMap {
-            { kResultOk, false },
-            { kResultErrName, job_interface.lastError().name() },
-            { kResultErrMsg, job_interface.lastError().message() },
-            {
-                kResult, QVariantMap {
-                    { kResultName, job },
-                }
-            }
-        };
-    }
+    Q_D(StoreDaemonManager);
+    d->controlJob(job, [](LastoreJobInterface * job_interface) {
+        return job_interface->Pause();
+    }, callback);
 }
 
-QVariantMap StoreDaemonManager::startJob(const QString &job)
+void StoreDaemonManager::startJob(const QString &job, ReplyCallback callback)
 {
-    LastoreJobInterface job_interface(kLastoreDebJobService,
-                                      job,
-                                      QDBusConnection::sessionBus(),
-                                      this);
-    if (job_interface.isValid()) {
-        const QDBusPendingReply<> reply = job_interface.Start();
-        if (reply.isError()) {
-            return QVariantMap {
-                { kResultOk, false },
-                { kResultErrName, reply.error().name() },
-                { kResultErrMsg, reply.error().message() },
-                { kResult, job}
-            };
-        } else {
-            return QVariantMap {
-                { kResultOk, true },
-                { kResultErrName, "" },
-                { kResultErrMsg, "" },
-                { kResult, job}
-            };
-        }
-    } else {
-        return QVariantMap {
-            { kResultOk, false },
-            { kResultErrName, job_interface.lastError().name() },
-            { kResultErrMsg, job_interface.lastError().message() },
-            { kResult, job}
-        };
-    }
+    Q_D(StoreDaemonManager);
+    d->controlJob(job, [](LastoreJobInterface * job_interface) {
+        return job_interface->Start();
+    }, callback);
 }
 
-QVariantMap StoreDaemonManager::installedPackages()
+void StoreDaemonManager::installedPackages(ReplyCallback callback,
+                                           CancelCheck cancelled)
 {
-    // TODO: filter install list
     Q_D(StoreDaemonManager);
-    auto result = d->pm->ListInstalled(/*d->apps.keys()*/{});
-    // qDebug() << result.data;
-    return QVariantMap {
-        { kResultOk, result.success },
-        { kResultErrName, result.errName },
-        { kResultErrMsg, result.errMsg },
-        { kResult, result.data},
-    };
+    if (IsCancelled(cancelled)) {
+        callback(CancelledReply());
+        return;
+    }
+    d->getInstalled(callback);
 }
 
-
-QVariantMap StoreDaemonManager::installPackage(const QVariantList &apps)
+void StoreDaemonManager::installedPackages(const QVariantMap &projection,
+                                           ReplyCallback callback,
+                                           CancelCheck cancelled)
 {
     Q_D(StoreDaemonManager);
+    if (IsCancelled(cancelled)) {
+        callback(CancelledReply());
+        return;
+    }
+    d->getInstalledProjected(Projection(projection), callback, cancelled);
+}
 
-    AppPackageList list;
-    for (auto v : apps) {
-        list.append(AppPackage::fromVariantMap(v.toMap()));
+void StoreDaemonManager::installedPackagesPage(const QVariantMap &page,
+                                               ReplyCallback callback,
+                                               CancelCheck cancelled)
+{
+    Q_D(StoreDaemonManager);
+    if (IsCancelled(cancelled)) {
+        callback(CancelledReply());
+        return;
     }
-    auto result = d->pm->Install(list);
+    const Projection projection(page);
+    const PageRequest request(page);
+    // Sort full packages, then project only packages in the page.
+    d->getInstalled([d, projection, request, callback, cancelled](const QVariantMap & reply) {
+        if (IsCancelled(cancelled)) {
+            callback(CancelledReply());
+            return;
+        }
+        QVariantMap result = reply;
+        if (!reply.value(kResultOk).toBool()) {
+            callback(result);
+            return;
+        }
 
-    return QVariantMap {
-        { kResultOk, result.success },
-        { kResultErrName, result.errName },
-        { kResultErrMsg, result.errMsg },
-        { kResult, result.data},
-    };
+        const QVariantList list = reply.value(kResult).toList();
+        const qlonglong version = reply.value(kResultVersion, -1).toLongLong();
+        // Only locale of projection changes order, by localName.
+        const QString sort_key = projection.locale + "|" + request.key();
+        QVariantList sorted;
+        if (version >= 0 && version == d->installed_sorted_version_ &&
+                sort_key == d->installed_sort_key_) {
+            sorted = d->installed_sorted_;
+        } else {
+            sorted = request.sorted(list, projection);
+            if (version >= 0) {
+                d->installed_sorted_ = sorted;
+                d->installed_sorted_version_ = version;
+                d->installed_sort_key_ = sort_key;
+            }
+        }
+
+        result.insert(kResult, projection.packages(request.slice(sorted)));
+        result.insert(kPageTotal, list.size());
+        result.insert(kPageOffset, request.offset);
+        callback(result);
+    });
 }
 
-QVariantMap StoreDaemonManager::updatePackage(const QVariantList &apps)
+void StoreDaemonManager::installedPackagesSince(qlonglong version, ReplyCallback callback)
 {
-    return this->installPackage(apps);
+    Q_D(StoreDaemonManager);
+    if (d->installed_valid_ && version == d->installed_version_) {
+        callback(QVariantMap {
+            { kResultOk, true },
+            { kResultErrName, "" },
+            { kResultErrMsg, "" },
+            { kResultVersion, version },
+        });
+        return;
+    }
+    d->getInstalled(callback);
 }
 
-QVariantMap StoreDaemonManager::removePackage(const QVariantList &apps)
+void StoreDaemonManager::installPackage(const QVariantList &apps, ReplyCallback callback)
 {
     Q_D(StoreDaemonManager);
+    d->pm->Install(ToAppPackageList(apps), [callback](const PMResult & result) {
+        callback(ToReply(result));
+    });
+}
 
-    AppPackageList list;
-    for (auto v : apps) {
-        list.append(AppPackage::fromVariantMap(v.toMap()));
-    }
-    auto result = d->pm->Remove(list);
+void StoreDaemonManager::updatePackage(const QVariantList &apps, ReplyCallback callback)
+{
+    this->installPackage(apps, callback);
+}
 
-    return QVariantMap {
-        { kResultOk, result.success },
-        { kResultErrName, result.errName },
-        { kResultErrMsg, result.errMsg },
-        { kResult, result.data},
-    };
+void StoreDaemonManager::removePackage(const QVariantList &apps, ReplyCallback callback)
+{
+    Q_D(StoreDaemonManager);
+    d->pm->Remove(ToAppPackageList(apps), [callback](const PMResult & result) {
+        callback(ToReply(result));
+    });
 }
 
-QVariantMap StoreDaemonManager::jobList()
+void StoreDaemonManager::jobList(ReplyCallback callback)
 {
     // TODO(Shaohua): List flatpak jobs.
     Q_D(StoreDaemonManager);
-    const QList<QDBusObjectPath> jobs = d->deb_interface_->jobList();
-    QStringList paths;
-    for (const QDBusObjectPath &job : jobs) {
-        paths.append(job.path());
+    if (d->job_list_valid_) {
+        callback(JobListReply(d->job_registry_->paths()));
+        return;
     }
-    return QVariantMap {
-        { kResultOk, true },
-        { kResultErrName, "" },
-        { kResultErrMsg, "" },
-        { kResult, paths }
-    };
+    d->job_list_waiters_.append(callback);
+    d->loadJobList();
 }
 
-QVariantMap StoreDaemonManager::queryVersions(const QStringList &apps)
+void StoreDaemonManager::queryVersions(const QStringList &apps, ReplyCallback callback)
 {
     Q_D(StoreDaemonManager);
-    auto result = d->pm->QueryVersion(apps);
-    return QVariantMap {
-        { kResultOk, result.success },
-        { kResultErrName, result.errName },
-        { kResultErrMsg, result.errMsg },
-        { kResult, result.data},
-    };
+    d->pm->QueryVersion(apps, [callback](const PMResult & result) {
+        callback(ToReply(result));
+    });
 }
 
-QVariantMap StoreDaemonManager::query(const QVariantList &apps)
+void StoreDaemonManager::upgradablePackages(const QVariantMap &catalog,
+                                            ReplyCallback callback)
 {
     Q_D(StoreDaemonManager);
+    d->getInstalled([d, catalog, callback](const QVariantMap & reply) {
+        if (!reply.value(kResultOk).toBool()) {
+            callback(reply);
+            return;
+        }
 
-    AppPackageList list;
-    for (auto v : apps) {
-        list.append(AppPackage::fromVariantMap(v.toMap()));
-    }
-    auto result = d->pm->Query(list);
-    return QVariantMap {
-        { kResultOk, result.success },
-        { kResultErrName, result.errName },
-        { kResultErrMsg, result.errMsg },
-        { kResult, result.data},
-    };
+        const qlonglong version = reply.value(kResultVersion, -1).toLongLong();
+        if (version < 0 || version != d->installed_versions_version_) {
+            d->installed_versions_.clear();
+            for (const QVariant &v : reply.value(kResult).toList()) {
+                const QVariantMap pkg = v.toMap();
+                // Catalog is keyed by app name, which might differ from
+                // name of its package.
+                QString app_name = pkg.value(kPackageAppName).toString();
+                if (app_name.isEmpty()) {
+                    app_name = PackageIDFromName(pkg.value(kPackageName).toString());
+                }
+                d->installed_versions_.insert(app_name,
+                                              pkg.value("localVersion").toString());
+            }
+            d->installed_versions_version_ = version;
+        }
+
+        QVariantList upgradable;
+        for (auto iter = catalog.cbegin(); iter != catalog.cend(); ++iter) {
+            const QString local = d->installed_versions_.value(iter.key());
+            const QString remote = iter.value().toString();
+            if (IsDebUpgradable(local, remote)) {
+                upgradable.append(QVariantMap {
+                    { "appName", iter.key() },
+                    { "localVersion", local },
+                    { "remoteVersion", remote },
+                });
+            }
+        }
+
+        callback(QVariantMap {
+            { kResultOk, true },
+            { kResultErrName, "" },
+            { kResultErrMsg, "" },
+            { kResultVersion, version },
+            { kResult, upgradable },
+        });
+    });
 }
 
-QVariantMap StoreDaemonManager::queryDownloadSize(const QVariantList &apps)
+void StoreDaemonManager::query(const QVariantList &apps, ReplyCallback callback,
+                               CancelCheck cancelled)
 {
     Q_D(StoreDaemonManager);
+    if (IsCancelled(cancelled)) {
+        callback(CancelledReply());
+        return;
+    }
+    d->pm->Query(ToAppPackageList(apps), [callback, cancelled](const PMAppResult & result) {
+        if (IsCancelled(cancelled)) {
+            callback(CancelledReply());
+            return;
+        }
+        callback(ToReply(result));
+    });
+}
 
-    AppPackageList list;
-    for (auto v : apps) {
-        list.append(AppPackage::fromVariantMap(v.toMap()));
+void StoreDaemonManager::query(const QVariantList &apps,
+                               const QVariantMap &projection,
+                               ReplyCallback callback,
+                               CancelCheck cancelled)
+{
+    const Projection proj(projection);
+    if (proj.isEmpty()) {
+        this->query(apps, callback, cancelled);
+        return;
     }
-    auto result = d->pm->QueryDownloadSize(list);
-    return QVariantMap {
-        { kResultOk, result.success },
-        { kResultErrName, result.errName },
-        { kResultErrMsg, result.errMsg },
-        { kResult, result.data},
-    };
+    this->query(apps, [proj, callback, cancelled](const QVariantMap & reply) {
+        if (IsCancelled(cancelled)) {
+            callback(CancelledReply());
+            return;
+        }
+        callback(proj.queryReply(reply));
+    }, cancelled);
+}
 
+void StoreDaemonManager::queryDownloadSize(const QVariantList &apps, ReplyCallback callback,
+                                           CancelCheck cancelled)
+{
+    Q_D(StoreDaemonManager);
+    if (IsCancelled(cancelled)) {
+        callback(CancelledReply());
+        return;
+    }
+    d->pm->QueryDownloadSize(ToAppPackageList(apps),
+                             [callback, cancelled](const PMAppResult & result) {
+        if (IsCancelled(cancelled)) {
+            callback(CancelledReply());
+            return;
+        }
+        callback(ToReply(result));
+    });
 }
 
-QVariantMap StoreDaemonManager::getJobInfo(const QString &job)
+void StoreDaemonManager::getJobInfo(const QString &job, ReplyCallback callback)
 {
-    QVariantMap result;
-    LastoreJobInterface job_interface(kLastoreDebJobService,
-                                      job,
-                                      QDBusConnection::sessionBus(),
-                                      this);
-    if (job_interface.isValid()) {
-        if (ReadJobInfo(job_interface, job, result)) {
-            return QVariantMap {
+    Q_D(StoreDaemonManager);
+    d->job_registry_->properties(job,
+    [job, callback](const QVariantMap & props, const QDBusError & error) {
+        QVariantMap result;
+        if (error.isValid()) {
+            callback(QVariantMap {
+                { kResultOk, false },
+                { kResultErrName, kErrInvalidJob },
+                { kResultErrMsg, error.message() },
+                {
+                    kResult, QVariantMap {
+                        { kResultName, job },
+                    }
+                },
+            });
+        } else if (ReadJobInfo(props, job, result)) {
+            callback(QVariantMap {
                 { kResultOk, true },
                 { kResultErrName, "" },
                 { kResultErrMsg, "" },
                 { kResult, result },
-            };
+            });
         } else {
-            return QVariantMap {
+            callback(QVariantMap {
                 { kResultOk, false },
                 { kResultErrName, "app name list is empty" },
                 { kResultErrMsg, "" },
                 { kResult, job },
-            };
+            });
         }
-    } else {
-        return QVariantMap {
-            { kResultOk, false },
-            { kResultErrName, "Invalid job interface" },
-            { kResultErrMsg, job_interface.lastError().message() },
-            {
-                kResult, QVariantMap {
-                    { kResultName, job },
-                }
-            },
-        };
-    }
+    });
 }
 
-QVariantMap StoreDaemonManager::getJobsInfo(const QStringList &jobs)
+void StoreDaemonManager::getJobsInfo(const QStringList &jobs, ReplyCallback callback)
 {
-    QVariantList jobs_info;
-    for (const QString &job : jobs) {
-        QVariantMap job_info;
-        LastoreJobInterface job_interface(kLastoreDebJobService,
-                                          job,
-                                          QDBusConnection::sessionBus());
-        if (job_interface.isValid()) {
-            if (ReadJobInfo(job_interface, job, job_info)) {
-                jobs_info.append(job_info);
-            } else {
-                qWarning() << "Invalid app_names for job:" << job;
+    Q_D(StoreDaemonManager);
+    // Properties of new jobs might still be fetched, reply once all of
+    // them are ready. The extra count covers jobs answered at once.
+    auto jobs_info = QSharedPointer<QVector<QVariantMap>>::create(jobs.size());
+    auto pending = QSharedPointer<int>::create(jobs.size() + 1);
+    auto finish = [jobs_info, pending, callback]() {
+        if (--(*pending) > 0) {
+            return;
+        }
+        QVariantList result;
+        for (const QVariantMap &job_info : *jobs_info) {
+            if (!job_info.isEmpty()) {
+                result.append(job_info);
             }
         }
-    }
-    return QVariantMap {
-        { kResultOk, true },
-        { kResultErrName, "" },
-        { kResultErrMsg, "" },
-        { kResult, jobs_info},
+        callback(QVariantMap {
+            { kResultOk, true },
+            { kResultErrName, "" },
+            { kResultErrMsg, "" },
+            { kResult, result},
+        });
     };
+
+    for (int i = 0; i < jobs.size(); ++i) {
+        const QString job = jobs.at(i);
+        d->job_registry_->properties(job,
+        [i, job, jobs_info, finish](const QVariantMap & props,
+                                    const QDBusError & error) {
+            if (!error.isValid() && !ReadJobInfo(props, job, (*jobs_info)[i])) {
+                qWarning() << "Invalid app_names for job:" << job;
+                (*jobs_info)[i].clear();
+            }
+            finish();
+        });
+    }
+    finish();
 }
 
-void StoreDaemonManager::onJobListChanged()
+void StoreDaemonManager::setJobsUpdateRate(int rate)
 {
     Q_D(StoreDaemonManager);
-    const QList<QDBusObjectPath> jobs = d->deb_interface_->jobList();
-    QStringList paths;
-    for (const QDBusObjectPath &job : jobs) {
-        paths.append(job.path());
+    d->jobs_update_rate_ = qBound(0, rate, kJobsUpdateMaxRate);
+    if (d->jobs_update_rate_ == 0) {
+        d->jobs_update_timer_->stop();
+        d->pending_job_updates_.clear();
     }
-    emit this->jobListChanged(paths);
 }
 
 QVariantMap StoreDaemonManager::fixError(const QString &error_type)
@@ -18,6 +18,8 @@
 #ifndef DEEPIN_APPSTORE_SERVICES_STORE_DAEMON_MANAGER_H
 #define DEEPIN_APPSTORE_SERVICES_STORE_DAEMON_MANAGER_H
 
+#include <functional>
+
 #include <QObject>
 #include <QScopedPointer>
 #include "services/search_result.h"
@@ -33,6 +35,93 @@ public:
     explicit StoreDaemonManager(QObject *parent = nullptr);
     ~StoreDaemonManager() override;
 
+    /**
+     * Receives result of an asynchronous request.
+     * It is called in the thread of StoreDaemonManager once backend replies.
+     */
+    typedef std::function<void(const QVariantMap &)> ReplyCallback;
+
+    /**
+     * Tells a long request that caller has cancelled it, so that it stops
+     * before querying backend or building result. A cancelled request still
+     * calls back, with a "Request cancelled" error.
+     */
+    typedef std::function<bool()> CancelCheck;
+
+    void installedPackages(ReplyCallback callback,
+                           CancelCheck cancelled = CancelCheck());
+
+    /**
+     * Same as installedPackages(), but each package is trimmed to |projection|:
+     * * fields: stringList, package fields to keep, all fields if empty.
+     * * locale: string, replace allLocalName with localName in this locale.
+     */
+    void installedPackages(const QVariantMap &projection, ReplyCallback callback,
+                           CancelCheck cancelled = CancelCheck());
+
+    /**
+     * Returns one page of installed packages, so that web page can render
+     * the first screen without waiting for the whole list.
+     * * offset: int, index of first package.
+     * * limit: int, max number of packages, all remaining if 0.
+     * * sort: string, package field to sort by, e.g. installedTime, it
+     *   need not be in fields.
+     * * order: string, "asc" or "desc".
+     * * fields, locale: projection of packages, see installedPackages().
+     * Reply also carries "total" number of packages and "offset".
+     */
+    void installedPackagesPage(const QVariantMap &page, ReplyCallback callback,
+                               CancelCheck cancelled = CancelCheck());
+
+    /**
+     * Same as installedPackages(), but result is left out if installed
+     * packages are not changed since |version|.
+     * @param version returned in last installedPackages() reply
+     */
+    void installedPackagesSince(qlonglong version, ReplyCallback callback);
+
+    void query(const QVariantList &apps, ReplyCallback callback,
+               CancelCheck cancelled = CancelCheck());
+
+    /**
+     * Same as query(), packages of each app are trimmed to |projection|,
+     * see installedPackages().
+     */
+    void query(const QVariantList &apps, const QVariantMap &projection,
+               ReplyCallback callback, CancelCheck cancelled = CancelCheck());
+
+    void queryDownloadSize(const QVariantList &apps, ReplyCallback callback,
+                           CancelCheck cancelled = CancelCheck());
+
+    /**
+     * apt-get install xxx
+     * @param apps
+     */
+    void installPackage(const QVariantList &apps, ReplyCallback callback);
+
+    /**
+     * apt-get upgrade xxx
+     * @param apps
+     */
+    void updatePackage(const QVariantList &apps, ReplyCallback callback);
+
+    /**
+     * apt-get remove xxx
+     * @param apps
+     */
+    void removePackage(const QVariantList &apps, ReplyCallback callback);
+
+    void queryVersions(const QStringList &apps, ReplyCallback callback);
+
+    /**
+     * Compare versions in |catalog| with cached installed packages, without
+     * querying backend once installed list is loaded.
+     * @param catalog app name => remote version
+     * Result is a list of { appName, localVersion, remoteVersion } of
+     * packages which are upgradable.
+     */
+    void upgradablePackages(const QVariantMap &catalog, ReplyCallback callback);
+
 Q_SIGNALS:
     /**
      * Emitted when JobList property changed.
@@ -40,6 +129,30 @@ Q_SIGNALS:
      */
     void jobListChanged(const QStringList &jobs);
 
+    /**
+     * Emitted when new jobs are created, changes are debounced.
+     * @param jobs paths of added jobs
+     */
+    void jobsAdded(const QStringList &jobs);
+
+    /**
+     * Emitted when jobs are finished and removed.
+     * @param jobs paths of removed jobs
+     */
+    void jobsRemoved(const QStringList &jobs);
+
+    /**
+     * Emitted when cached installed package list is reloaded.
+     * @param version new version of installed package list
+     */
+    void installedPackagesChanged(qlonglong version);
+
+    /**
+     * Emitted periodically while subscribed with setJobsUpdateRate().
+     * @param jobs job path => changed fields of job info since last signal
+     */
+    void jobsUpdated(const QVariantMap &jobs);
+
 
     /*
         system login state change
@@ -69,51 +182,23 @@ public Q_SLOTS:
     // update all list of app
     void updateAppList(const SearchMetaList &app_list);
 
-    QVariantMap installedPackages();
-
-    QVariantMap query(const QVariantList &apps);
-
-    QVariantMap queryDownloadSize(const QVariantList &apps);
-
-    /**
-     * apt-get install xxx
-     * @param app_name
-     * @param app_local_name
-     */
-    QVariantMap installPackage(const QVariantList &apps);
-
-    /**
-     * apt-get upgrade xxx
-     * @param app_name
-     * @param app_local_name
-     */
-    QVariantMap updatePackage(const QVariantList &apps);
-    /**
-     * apt-get remove xxx
-     * @param app_name
-     * @param app_local_name
-     */
-    QVariantMap removePackage(const QVariantList &apps);
-
-    QVariantMap queryVersions(const QStringList &apps);
-
     /**
      * Clean up a specific job.
      * @param job
      */
-    QVariantMap cleanJob(const QString &job);
+    void cleanJob(const QString &job, ReplyCallback callback);
 
     /**
      * Pause a running job
      * @param job
      */
-    QVariantMap pauseJob(const QString &job);
+    void pauseJob(const QString &job, ReplyCallback callback);
 
     /**
      * Resume a paused job
      * @param job
      */
-    QVariantMap startJob(const QString &job);
+    void startJob(const QString &job, ReplyCallback callback);
 
 
     /**
@@ -129,17 +214,26 @@ public Q_SLOTS:
      * * cancelable: boolean
      * * packages: stringList
      */
-    QVariantMap getJobInfo(const QString &job);
+    void getJobInfo(const QString &job, ReplyCallback callback);
 
-    QVariantMap getJobsInfo(const QStringList &jobs);
+    /**
+     * Get info of |jobs| in requested order, jobs not in job list are
+     * skipped.
+     */
+    void getJobsInfo(const QStringList &jobs, ReplyCallback callback);
 
     /**
-     * Returns all of jobs existing in backend.
-     * @return stringList
+     * Push changes of jobs with jobsUpdated() at most |rate| times
+     * per second, up to 1000, set |rate| to 0 to stop.
      */
-    QVariantMap jobList();
+    void setJobsUpdateRate(int rate);
 
-    void onJobListChanged();
+    /**
+     * Returns all of jobs existing in backend, as stringList.
+     * Served from job registry, JobList property is only read once if
+     * backend has not pushed it yet.
+     */
+    void jobList(ReplyCallback callback);
 
 private:
     QScopedPointer<StoreDaemonManagerPrivate> dd_ptr;
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include "services/package/deb_version.h"
+
+namespace dstore {
+
+class DebVersionTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void compare_data();
+  void compare();
+  void upgradable();
+};
+
+void DebVersionTest::compare_data() {
+  QTest::addColumn<QString>("a");
+  QTest::addColumn<QString>("b");
+  QTest::addColumn<int>("expected");
+
+  // Results of `dpkg --compare-versions a lt/eq/gt b`.
+  QTest::newRow("equal") << "1.0" << "1.0" << 0;
+  QTest::newRow("revision") << "1.0" << "1.0-1" << -1;
+  QTest::newRow("tilde before release") << "1.0~rc1" << "1.0" << -1;
+  QTest::newRow("double tilde") << "1.0~~" << "1.0~" << -1;
+  QTest::newRow("tilde before empty") << "1.0~" << "1.0" << -1;
+  QTest::newRow("empty before letter") << "1.0" << "1.0a" << -1;
+  QTest::newRow("letter before plus") << "1.0a" << "1.0+b1" << -1;
+  QTest::newRow("plus before dot") << "1.0+b1" << "1.0.1" << -1;
+  QTest::newRow("leading zeros") << "1.00" << "1.0" << 0;
+  QTest::newRow("leading zero") << "01.0" << "1.0" << 0;
+  QTest::newRow("zero epoch") << "0:1.0" << "1.0" << 0;
+  QTest::newRow("epoch wins") << "1:0.9" << "2.0" << 1;
+  QTest::newRow("higher epoch") << "2:0" << "1:9.9" << 1;
+  QTest::newRow("numeric revision") << "1.0-9" << "1.0-10" << -1;
+  QTest::newRow("backport") << "1.0-1~bpo" << "1.0-1" << -1;
+  QTest::newRow("vendor revision") << "1.0-1ubuntu1" << "1.0-1" << 1;
+  QTest::newRow("numeric") << "9" << "10" << -1;
+  QTest::newRow("deepin revision")
+      << "1.2.3+dfsg-4" << "1.2.3+dfsg-4deepin1" << -1;
+  QTest::newRow("more parts") << "5.0.0.1-1" << "5.0.0-1" << 1;
+}
+
+void DebVersionTest::compare() {
+  QFETCH(QString, a);
+  QFETCH(QString, b);
+  QFETCH(int, expected);
+
+  const auto sign = [](int value) {
+    return value < 0 ? -1 : (value > 0 ? 1 : 0);
+  };
+  QCOMPARE(sign(CompareDebVersion(a, b)), expected);
+  QCOMPARE(sign(CompareDebVersion(b, a)), -expected);
+}
+
+void DebVersionTest::upgradable() {
+  QVERIFY(IsDebUpgradable("1.0-1", "1.0-2"));
+  QVERIFY(IsDebUpgradable("1:0.9", "1:1.0"));
+  QVERIFY(!IsDebUpgradable("1.0-2", "1.0-1"));
+  QVERIFY(!IsDebUpgradable("1.0", "1.0"));
+  QVERIFY(!IsDebUpgradable("1.0", "1.0~rc1"));
+  // Not installed.
+  QVERIFY(!IsDebUpgradable("", "1.0"));
+}
+
+}  // namespace dstore
+
+QTEST_GUILESS_MAIN(dstore::DebVersionTest)
+
+#include "deb_version_test.moc"
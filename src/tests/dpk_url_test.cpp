@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include "services/package/dpk_url.h"
+
+namespace dstore {
+
+class DpkUrlTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void parse_data();
+  void parse();
+  void sharesValidIDs();
+  void packageIDFromName();
+};
+
+void DpkUrlTest::parse_data() {
+  QTest::addColumn<QString>("url");
+  QTest::addColumn<bool>("valid");
+  QTest::addColumn<QString>("type");
+  QTest::addColumn<QString>("id");
+
+  QTest::newRow("deb") << "dpk://deb/deepin-manual" << true << "deb"
+                       << "deepin-manual";
+  QTest::newRow("flatpak") << "dpk://flatpak/org.deepin.flatdeb.dde-calendar"
+                           << true << "flatpak"
+                           << "org.deepin.flatdeb.dde-calendar";
+  QTest::newRow("longest id") << "dpk://deb/" + QString(64, 'a') << true
+                              << "deb" << QString(64, 'a');
+  QTest::newRow("id too long") << "dpk://deb/" + QString(65, 'a') << false
+                               << "deb" << QString(65, 'a');
+  QTest::newRow("no scheme") << "deb/deepin-manual" << false << "deb"
+                             << "deepin-manual";
+  QTest::newRow("other scheme") << "http://deb/deepin-manual" << false
+                                << "http:" << "/deb/deepin-manual";
+  QTest::newRow("unknown type") << "dpk://rpm/deepin-manual" << false
+                                << "rpm" << "deepin-manual";
+  QTest::newRow("type case") << "dpk://DEB/deepin-manual" << false << "DEB"
+                             << "deepin-manual";
+  QTest::newRow("empty id") << "dpk://deb/" << false << "deb" << "";
+  QTest::newRow("nested id") << "dpk://deb/a/b" << false << "deb" << "a/b";
+  QTest::newRow("no slash") << "dpk://deb" << false << "" << "";
+  QTest::newRow("empty") << "" << false << "" << "";
+}
+
+void DpkUrlTest::parse() {
+  QFETCH(QString, url);
+  QFETCH(bool, valid);
+  QFETCH(QString, type);
+  QFETCH(QString, id);
+
+  const DpkURI dpk(url);
+  QCOMPARE(dpk.isValid(), valid);
+  QCOMPARE(dpk.getType(), type);
+  QCOMPARE(dpk.getID(), id);
+  QCOMPARE(dpk.toString(), url);
+}
+
+void DpkUrlTest::sharesValidIDs() {
+  // Build urls at runtime so that they do not share literal data.
+  const QString name = QString("dpk-url-test-%1").arg(1);
+  const DpkURI first(QString("dpk://deb/") + name);
+  const DpkURI second(QString("dpk://deb/") + name);
+  QVERIFY(first.isValid());
+  QCOMPARE(first.getID().constData(), second.getID().constData());
+  QCOMPARE(first.getType().constData(), second.getType().constData());
+  QCOMPARE(PackageIDFromName(name).constData(), first.getID().constData());
+}
+
+void DpkUrlTest::packageIDFromName() {
+  QCOMPARE(PackageIDFromName("deepin-manual:amd64"),
+           QString("deepin-manual"));
+  QCOMPARE(PackageIDFromName("deepin-manual"), QString("deepin-manual"));
+  QCOMPARE(PackageIDFromName(""), QString());
+  QCOMPARE(PackageIDFromName("deepin-manual:i386").constData(),
+           PackageIDFromName("deepin-manual:amd64").constData());
+}
+
+}  // namespace dstore
+
+QTEST_GUILESS_MAIN(dstore::DpkUrlTest)
+
+#include "dpk_url_test.moc"
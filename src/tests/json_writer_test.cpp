@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits>
+
+#include <QJsonDocument>
+#include <QtTest>
+
+#include "base/json_writer.h"
+
+namespace dstore {
+
+class JsonWriterTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void scalars_data();
+  void scalars();
+  void escapes();
+  void sameAsQJsonDocument_data();
+  void sameAsQJsonDocument();
+  void appends();
+};
+
+void JsonWriterTest::scalars_data() {
+  QTest::addColumn<QVariant>("value");
+  QTest::addColumn<QByteArray>("expected");
+
+  QTest::newRow("invalid") << QVariant() << QByteArray("null");
+  QTest::newRow("true") << QVariant(true) << QByteArray("true");
+  QTest::newRow("false") << QVariant(false) << QByteArray("false");
+  QTest::newRow("int") << QVariant(-42) << QByteArray("-42");
+  QTest::newRow("longlong") << QVariant(Q_INT64_C(1) << 40)
+                            << QByteArray("1099511627776");
+  QTest::newRow("uint") << QVariant(4000000000u) << QByteArray("4000000000");
+  QTest::newRow("double") << QVariant(1.5) << QByteArray("1.5");
+  QTest::newRow("nan")
+      << QVariant(std::numeric_limits<double>::quiet_NaN())
+      << QByteArray("null");
+  QTest::newRow("infinity")
+      << QVariant(std::numeric_limits<double>::infinity())
+      << QByteArray("null");
+  QTest::newRow("string") << QVariant("deepin") << QByteArray("\"deepin\"");
+  QTest::newRow("empty list") << QVariant(QVariantList())
+                              << QByteArray("[]");
+  QTest::newRow("empty map") << QVariant(QVariantMap()) << QByteArray("{}");
+  QTest::newRow("string list")
+      << QVariant(QStringList{ "a", "b" }) << QByteArray("[\"a\",\"b\"]");
+  QTest::newRow("convertible") << QVariant(QByteArray("raw"))
+                               << QByteArray("\"raw\"");
+  QTest::newRow("not convertible") << QVariant(QRect(0, 0, 1, 1))
+                                   << QByteArray("null");
+}
+
+void JsonWriterTest::scalars() {
+  QFETCH(QVariant, value);
+  QFETCH(QByteArray, expected);
+  QCOMPARE(ToCompactJson(value), expected);
+}
+
+void JsonWriterTest::escapes() {
+  const QString str = QString::fromUtf8("q\"b\\n\nt\tc\x01\x1f 中文");
+  QCOMPARE(ToCompactJson(str),
+           QByteArray("\"q\\\"b\\\\n\\nt\\tc\\u0001\\u001f ") +
+               QString::fromUtf8("中文").toUtf8() + QByteArray("\""));
+}
+
+void JsonWriterTest::sameAsQJsonDocument_data() {
+  QTest::addColumn<QVariant>("value");
+
+  QVariantMap package;
+  package.insert("packageName", "deepin-manual");
+  package.insert("localVersion", "1.0-1");
+  package.insert("size", 1024);
+  package.insert("installed", true);
+  package.insert("allLocalName", QVariantMap{
+      { "zh_CN", QString::fromUtf8("帮助手册") },
+      { "en_US", "Manual" },
+  });
+  QTest::newRow("package") << QVariant(package);
+
+  QVariantList list;
+  list << package << QVariant() << 2.25 << QString("line\nbreak");
+  QTest::newRow("list") << QVariant(list);
+
+  QVariantHash hash;
+  hash.insert("b", QVariantList{ 1, 2, 3 });
+  hash.insert("a", QVariantMap{ { "nested", "tab\there" } });
+  QTest::newRow("hash") << QVariant(hash);
+}
+
+void JsonWriterTest::sameAsQJsonDocument() {
+  QFETCH(QVariant, value);
+  const QByteArray expected =
+      QJsonDocument::fromVariant(value).toJson(QJsonDocument::Compact);
+  const QByteArray json = ToCompactJson(value);
+  if (value.type() == QVariant::Hash) {
+    // Hash is unordered, compare parsed documents instead.
+    QCOMPARE(QJsonDocument::fromJson(json), QJsonDocument::fromJson(expected));
+  } else {
+    QCOMPARE(json, expected);
+  }
+}
+
+void JsonWriterTest::appends() {
+  QByteArray out("prefix:");
+  AppendJson(QVariantList{ 1, "a" }, out);
+  QCOMPARE(out, QByteArray("prefix:[1,\"a\"]"));
+
+  out.clear();
+  AppendJsonString("x\"y", out);
+  QCOMPARE(out, QByteArray("\"x\\\"y\""));
+}
+
+}  // namespace dstore
+
+QTEST_GUILESS_MAIN(dstore::JsonWriterTest)
+
+#include "json_writer_test.moc"
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include "services/package/single_flight.h"
+
+namespace dstore {
+
+namespace {
+
+typedef SingleFlight<int> IntFlight;
+
+// Records fetches and holds their callbacks until replied by test.
+struct FakeBackend {
+  QList<QStringList> requests;
+  QList<IntFlight::Callback> pending;
+
+  IntFlight::Fetch fetch() {
+    return [this](const QStringList& ids, IntFlight::Callback callback) {
+      QStringList sorted = ids;
+      sorted.sort();
+      requests.append(sorted);
+      pending.append(callback);
+    };
+  }
+
+  // Replies |index|-th fetch, each id is answered by its length.
+  void reply(int index, const QDBusError& error = QDBusError()) {
+    IntFlight::ValueMap values;
+    if (!error.isValid()) {
+      for (const QString& id : requests.at(index)) {
+        values.insert(id, id.length());
+      }
+    }
+    pending.at(index)(error, values);
+  }
+};
+
+struct Result {
+  int calls = 0;
+  QDBusError error;
+  IntFlight::ValueMap values;
+
+  IntFlight::Callback callback() {
+    return [this](const QDBusError& reply_error,
+                  const IntFlight::ValueMap& reply_values) {
+      calls++;
+      error = reply_error;
+      values = reply_values;
+    };
+  }
+};
+
+}  // namespace
+
+class SingleFlightTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void emptyIds();
+  void fanOut();
+  void onlyFetchesMissing();
+  void duplicateIds();
+  void keepsRequestedIds();
+  void error();
+  void lateReply();
+};
+
+void SingleFlightTest::emptyIds() {
+  IntFlight flight;
+  FakeBackend backend;
+  Result result;
+  flight.run(QStringList(), backend.fetch(), result.callback());
+  QCOMPARE(result.calls, 1);
+  QVERIFY(result.values.isEmpty());
+  QVERIFY(backend.requests.isEmpty());
+}
+
+void SingleFlightTest::fanOut() {
+  IntFlight flight;
+  FakeBackend backend;
+  Result first;
+  Result second;
+  flight.run({ "a", "bb" }, backend.fetch(), first.callback());
+  flight.run({ "bb", "a" }, backend.fetch(), second.callback());
+  QCOMPARE(backend.requests.size(), 1);
+  QCOMPARE(first.calls, 0);
+
+  backend.reply(0);
+  const IntFlight::ValueMap expected{ { "a", 1 }, { "bb", 2 } };
+  QCOMPARE(first.calls, 1);
+  QCOMPARE(first.values, expected);
+  QCOMPARE(second.calls, 1);
+  QCOMPARE(second.values, expected);
+
+  // Finished flights are not shared any more.
+  Result third;
+  flight.run({ "a" }, backend.fetch(), third.callback());
+  QCOMPARE(backend.requests.size(), 2);
+}
+
+void SingleFlightTest::onlyFetchesMissing() {
+  IntFlight flight;
+  FakeBackend backend;
+  Result first;
+  Result second;
+  flight.run({ "a", "bb" }, backend.fetch(), first.callback());
+  flight.run({ "bb", "ccc" }, backend.fetch(), second.callback());
+  QCOMPARE(backend.requests.size(), 2);
+  QCOMPARE(backend.requests.at(1), QStringList{ "ccc" });
+
+  // Second caller waits for both flights.
+  backend.reply(0);
+  QCOMPARE(first.calls, 1);
+  QCOMPARE(second.calls, 0);
+  backend.reply(1);
+  QCOMPARE(second.calls, 1);
+  const IntFlight::ValueMap expected{ { "bb", 2 }, { "ccc", 3 } };
+  QCOMPARE(second.values, expected);
+}
+
+void SingleFlightTest::duplicateIds() {
+  IntFlight flight;
+  FakeBackend backend;
+  Result result;
+  flight.run({ "a", "a", "bb" }, backend.fetch(), result.callback());
+  QCOMPARE(backend.requests.size(), 1);
+  QCOMPARE(backend.requests.at(0), (QStringList{ "a", "bb" }));
+  backend.reply(0);
+  QCOMPARE(result.calls, 1);
+  QCOMPARE(result.values.size(), 2);
+}
+
+void SingleFlightTest::keepsRequestedIds() {
+  IntFlight flight;
+  FakeBackend backend;
+  Result amd64;
+  Result i386;
+  flight.run({ "foo:amd64" }, backend.fetch(), amd64.callback());
+  flight.run({ "foo:i386" }, backend.fetch(), i386.callback());
+  QCOMPARE(backend.requests.size(), 2);
+
+  backend.reply(1);
+  QCOMPARE(amd64.calls, 0);
+  QCOMPARE(i386.calls, 1);
+  QCOMPARE(i386.values.keys(), QStringList{ "foo:i386" });
+}
+
+void SingleFlightTest::error() {
+  IntFlight flight;
+  FakeBackend backend;
+  Result first;
+  Result second;
+  flight.run({ "a" }, backend.fetch(), first.callback());
+  flight.run({ "a", "bb" }, backend.fetch(), second.callback());
+  backend.reply(1);
+  QCOMPARE(second.calls, 0);
+
+  backend.reply(0, QDBusError(QDBusError::NoReply, "timeout"));
+  QCOMPARE(first.calls, 1);
+  QVERIFY(first.error.isValid());
+  QCOMPARE(second.calls, 1);
+  QCOMPARE(second.error.type(), QDBusError::NoReply);
+}
+
+void SingleFlightTest::lateReply() {
+  FakeBackend backend;
+  Result result;
+  {
+    IntFlight flight;
+    flight.run({ "a" }, backend.fetch(), result.callback());
+  }
+  backend.reply(0);
+  QCOMPARE(result.calls, 0);
+}
+
+}  // namespace dstore
+
+QTEST_GUILESS_MAIN(dstore::SingleFlightTest)
+
+#include "single_flight_test.moc"
@@ -1,35 +1,58 @@
 #include "account_proxy.h"
 
 #include "services/account_manager.h"
+#include "ui/channel/proxy_worker.h"
 
 namespace dstore
 {
 
 AccountProxy::AccountProxy(QObject *parent) : QObject(parent)
 {
-    manager_ = new AccountManager(parent);
+    worker_ = new ProxyWorker("AccountWorker", this);
+    manager_ = new AccountManager();
+    worker_->adopt(manager_);
     connect(manager_, &AccountManager::userInfoChanged,
             this, &AccountProxy::userInfoChanged);
+    connect(worker_, &ProxyWorker::replyReady,
+            this, &AccountProxy::deferredReplyReady,
+            Qt::DirectConnection);
+}
+
+void AccountProxy::cancelRequest(const QString &token)
+{
+    worker_->cancel(token);
 }
 
 QVariantMap dstore::AccountProxy::getUserInfo() const
 {
-    return manager_->getUserInfo();
+    auto manager = manager_;
+    return worker_->defer([manager](ProxyWorker::Reply reply) {
+        reply(manager->getUserInfo());
+    });
 }
 
-QString dstore::AccountProxy::getToken() const
+QVariantMap dstore::AccountProxy::getToken() const
 {
-    return manager_->getToken();
+    auto manager = manager_;
+    return worker_->defer([manager](ProxyWorker::Reply reply) {
+        reply(manager->getToken());
+    });
 }
 
 void dstore::AccountProxy::login()
 {
-    manager_->login();
+    auto manager = manager_;
+    worker_->post([manager]() {
+        manager->login();
+    });
 }
 
 void dstore::AccountProxy::logout()
 {
-    manager_->logout();
+    auto manager = manager_;
+    worker_->post([manager]() {
+        manager->logout();
+    });
 }
 
 } // namespace dstore
@@ -6,25 +6,38 @@
 namespace dstore
 {
 class AccountManager;
+class ProxyWorker;
 class AccountProxy : public QObject
 {
     Q_OBJECT
 public:
     explicit AccountProxy(QObject *parent = Q_NULLPTR);
 
+    /**
+     * Stop deferred call |token| cancelled by web page, thread safe.
+     */
+    void cancelRequest(const QString &token);
+
 Q_SIGNALS:
     void userInfoChanged(const QVariantMap &info);
 
+    /**
+     * Emitted when result of a deferred call is ready.
+     */
+    void deferredReplyReady(const QString &token, const QByteArray &json);
+
 public Q_SLOTS:
     QVariantMap getUserInfo() const;
 
-    QString getToken() const;
+    QVariantMap getToken() const;
 
     void login();
 
     void logout();
 
 private:
+    // Account manager lives in worker, as it talks to daemon over DBus.
+    ProxyWorker *worker_;
     AccountManager *manager_;
 };
 
@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ui/channel/channel_proxy.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMap>
+#include <QMetaMethod>
+#include <QMutexLocker>
+#include <QStringList>
+
+#include "base/json_writer.h"
+
+namespace dstore {
+
+namespace {
+
+const int kNanosPerMilli = 1000 * 1000;
+
+// Method calls and signals are keyed by object and method index, other
+// messages by their type.
+QString StatsKey(const QJsonObject& msg) {
+  const int type = msg.value("type").toInt();
+  if (type == kChannelMessageInvokeMethod) {
+    return QString("%1/%2").arg(msg.value("object").toString())
+        .arg(msg.value("method").toInt());
+  }
+  if (type == kChannelMessageSignal) {
+    return QString("%1/%2").arg(msg.value("object").toString())
+        .arg(msg.value("signal").toInt());
+  }
+  return QString("type/%1").arg(type);
+}
+
+// Convert key to "object.method(args)" readable in dump.
+QString StatsName(const QString& key,
+                  const QHash<QString, QObject*>& objects) {
+  const QString object = key.section('/', 0, 0);
+  const int index = key.section('/', 1).toInt();
+  const QObject* target = objects.value(object);
+  if (target == nullptr || index >= target->metaObject()->methodCount()) {
+    return key;
+  }
+  return QString("%1.%2").arg(object).arg(QString::fromLatin1(
+      target->metaObject()->method(index).methodSignature()));
+}
+
+}  // namespace
+
+ChannelTransport::ChannelTransport(QObject* parent)
+    : QWebChannelAbstractTransport(parent) {
+  clock_.start();
+}
+
+void ChannelTransport::callReceived(const QJsonObject& msg) {
+  if (msg.value("type").toInt() == kChannelMessageInvokeMethod &&
+      msg.contains("id")) {
+    QMutexLocker locker(&deferred_mutex_);
+    calling_ids_.insert(msg.value("id").toInt());
+  }
+}
+
+void ChannelTransport::sendMessage(const QJsonObject& msg) {
+  if (msg.value("type").toInt() == kChannelMessageResponse) {
+    const int id = msg.value("id").toInt();
+    const QString token = msg.value("data").toObject()
+        .value(kDeferredReplyKey).toString();
+    if (!token.isEmpty()) {
+      this->holdResponse(id, token, msg);
+      return;
+    }
+    // Call is finished, nothing to cancel.
+    QMutexLocker locker(&deferred_mutex_);
+    calling_ids_.remove(id);
+    cancelled_ids_.remove(id);
+  }
+  const QByteArray json = QJsonDocument(msg).toJson(QJsonDocument::Compact);
+  this->recordSent(msg, json.size());
+  this->appendFrame(json);
+}
+
+void ChannelTransport::cancel(int id) {
+  QMutexLocker locker(&deferred_mutex_);
+  if (!deferred_tokens_.contains(id)) {
+    if (calling_ids_.contains(id)) {
+      cancelled_ids_.insert(id);
+    }
+    return;
+  }
+  const QString token = deferred_tokens_.take(id);
+  const QJsonObject msg = deferred_responses_.take(token);
+  cancelled_tokens_.insert(token);
+  locker.unlock();
+  emit this->requestCancelled(token);
+  this->sendResponse(msg, kCancelledReply);
+}
+
+void ChannelTransport::reply(const QString& token, const QVariant& result) {
+  this->replyJson(token, ToCompactJson(result));
+}
+
+void ChannelTransport::replyJson(const QString& token,
+                                 const QByteArray& json) {
+  QMutexLocker locker(&deferred_mutex_);
+  if (cancelled_tokens_.remove(token)) {
+    return;
+  }
+  if (!deferred_responses_.contains(token)) {
+    deferred_results_.insert(token, json);
+    return;
+  }
+  const QJsonObject msg = deferred_responses_.take(token);
+  deferred_tokens_.remove(msg.value("id").toInt());
+  locker.unlock();
+  this->sendResponse(msg, json);
+}
+
+void ChannelTransport::holdResponse(int id,
+                                    const QString& token,
+                                    const QJsonObject& msg) {
+  QMutexLocker locker(&deferred_mutex_);
+  calling_ids_.remove(id);
+  if (cancelled_ids_.remove(id)) {
+    // Cancelled before the slot returned.
+    const bool finished = deferred_results_.remove(token) > 0;
+    if (!finished) {
+      cancelled_tokens_.insert(token);
+    }
+    locker.unlock();
+    if (!finished) {
+      emit this->requestCancelled(token);
+    }
+    this->sendResponse(msg, kCancelledReply);
+    return;
+  }
+  if (!deferred_results_.contains(token)) {
+    deferred_responses_.insert(token, msg);
+    deferred_tokens_.insert(id, token);
+    return;
+  }
+  const QByteArray json = deferred_results_.take(token);
+  locker.unlock();
+  this->sendResponse(msg, json);
+}
+
+void ChannelTransport::sendResponse(QJsonObject msg, const QByteArray& json) {
+  msg.remove("data");
+  QByteArray frame = QJsonDocument(msg).toJson(QJsonDocument::Compact);
+  frame.chop(1);
+  frame.append(",\"data\":");
+  frame.append(json);
+  frame.append('}');
+  this->recordSent(msg, frame.size());
+  this->appendFrame(frame);
+}
+
+void ChannelTransport::appendFrame(const QByteArray& msg) {
+  QMutexLocker locker(&frame_mutex_);
+  frame_.append(frame_.isEmpty() ? '[' : ',');
+  frame_.append(msg);
+  if (!flush_pending_) {
+    flush_pending_ = true;
+    QMetaObject::invokeMethod(this, [this]() {
+      this->flushFrame();
+    }, Qt::QueuedConnection);
+  }
+}
+
+void ChannelTransport::flushFrame() {
+  QByteArray frame;
+  {
+    QMutexLocker locker(&frame_mutex_);
+    frame.swap(frame_);
+    flush_pending_ = false;
+  }
+  if (frame.isEmpty()) {
+    return;
+  }
+  frame.append(']');
+  {
+    QMutexLocker locker(&stats_mutex_);
+    frames_out_++;
+    bytes_out_ += frame.size();
+  }
+  emit this->sendMessageString(QString::fromUtf8(frame));
+}
+
+void ChannelTransport::recordFrameReceived(int bytes) {
+  QMutexLocker locker(&stats_mutex_);
+  frames_in_++;
+  bytes_in_ += bytes;
+}
+
+void ChannelTransport::recordReceived(const QJsonObject& msg, int bytes) {
+  const QString key = StatsKey(msg);
+  QMutexLocker locker(&stats_mutex_);
+  TrafficStats& stats = stats_[key];
+  stats.received++;
+  stats.bytes_in += bytes;
+  if (msg.value("type").toInt() == kChannelMessageInvokeMethod &&
+      msg.contains("id")) {
+    pending_calls_.insert(msg.value("id").toInt(),
+                          PendingCall { key, clock_.nsecsElapsed() });
+  }
+}
+
+void ChannelTransport::recordSent(const QJsonObject& msg, int bytes) {
+  QMutexLocker locker(&stats_mutex_);
+  if (msg.value("type").toInt() == kChannelMessageResponse) {
+    // Count response under method being called.
+    auto iter = pending_calls_.find(msg.value("id").toInt());
+    if (iter != pending_calls_.end()) {
+      const qint64 elapsed = clock_.nsecsElapsed() - iter->start_ns;
+      TrafficStats& stats = stats_[iter->key];
+      stats.sent++;
+      stats.bytes_out += bytes;
+      stats.replies++;
+      stats.total_ns += elapsed;
+      stats.max_ns = qMax(stats.max_ns, elapsed);
+      pending_calls_.erase(iter);
+      return;
+    }
+  }
+  TrafficStats& stats = stats_[StatsKey(msg)];
+  stats.sent++;
+  stats.bytes_out += bytes;
+}
+
+QString ChannelTransport::dumpStats() {
+  QMutexLocker locker(&stats_mutex_);
+  QStringList lines;
+  lines.append(QString("frames in %1 (%2 bytes), frames out %3 (%4 bytes), "
+                       "calls in flight %5")
+                   .arg(frames_in_).arg(bytes_in_)
+                   .arg(frames_out_).arg(bytes_out_)
+                   .arg(pending_calls_.size()));
+  lines.append(QString("%1 %2 %3 %4 %5 %6 %7")
+                   .arg("method", -56)
+                   .arg("in", 7)
+                   .arg("out", 7)
+                   .arg("bytes_in", 10)
+                   .arg("bytes_out", 10)
+                   .arg("avg(ms)", 9)
+                   .arg("max(ms)", 9));
+
+  // Sort by readable name.
+  QMap<QString, TrafficStats> sorted;
+  for (auto iter = stats_.cbegin(); iter != stats_.cend(); ++iter) {
+    sorted.insert(StatsName(iter.key(), objects_), iter.value());
+  }
+  for (auto iter = sorted.cbegin(); iter != sorted.cend(); ++iter) {
+    const TrafficStats& stats = iter.value();
+    const double avg = stats.replies > 0 ?
+        double(stats.total_ns) / stats.replies / kNanosPerMilli : 0;
+    lines.append(QString("%1 %2 %3 %4 %5 %6 %7")
+                     .arg(iter.key(), -56)
+                     .arg(stats.received, 7)
+                     .arg(stats.sent, 7)
+                     .arg(stats.bytes_in, 10)
+                     .arg(stats.bytes_out, 10)
+                     .arg(avg, 9, 'f', 3)
+                     .arg(double(stats.max_ns) / kNanosPerMilli, 9, 'f', 3));
+  }
+  return lines.join("\n");
+}
+
+void ChannelProxy::send(const QString& msgData) {
+  const QByteArray data = msgData.toUtf8();
+  this->transport->recordFrameReceived(data.size());
+  auto doc = QJsonDocument::fromJson(data);
+  if (doc.isObject()) {
+    this->receive(doc.object(), data.size());
+  } else if (doc.isArray()) {
+    // Frame size is shared among its messages instead of encoding
+    // each of them again.
+    const QJsonArray messages = doc.array();
+    const int bytes = data.size() / qMax(1, messages.size());
+    for (const QJsonValue& msg : messages) {
+      this->receive(msg.toObject(), bytes);
+    }
+  }
+}
+
+void ChannelProxy::receive(const QJsonObject& msg, int bytes) {
+  this->transport->recordReceived(msg, bytes);
+  if (msg.contains(kCancelRequestKey)) {
+    this->transport->cancel(msg.value(kCancelRequestKey).toInt());
+  } else {
+    this->transport->callReceived(msg);
+    emit this->transport->messageReceived(msg, this->transport);
+  }
+}
+
+}  // namespace dstore
@@ -1,28 +1,178 @@
+#pragma once
 
 #include <QObject>
 #include <QWebChannelAbstractTransport>
-#include <QJsonDocument>
 #include <QJsonObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QVariantMap>
 
 namespace dstore {
 
+// Message types, see qwebchannel.js.
+const int kChannelMessageSignal = 1;
+const int kChannelMessageInvokeMethod = 6;
+const int kChannelMessageResponse = 10;
+const char kDeferredReplyKey[] = "__dstoreDeferredReply";
+// Web page sends { __dstoreCancel: id } to cancel call |id| in flight,
+// which is then replied with { __dstoreCancelled: true }.
+const char kCancelRequestKey[] = "__dstoreCancel";
+const char kCancelledReply[] = "{\"__dstoreCancelled\":true}";
+
+/**
+ * Returns an unique token to mark a deferred slot call.
+ */
+inline QString NewDeferredReplyToken() {
+  static QAtomicInt counter;
+  return QString::number(counter.fetchAndAddOrdered(1) + 1);
+}
+
 /**
- * This proxy object is used by web page to write log messages to local
- * log file.
+ * Slots exposed to web page may return DeferredReply(token) immediately and
+ * deliver real result later with ChannelTransport::reply(token, result).
+ * Web page just receives the result in its callback when it is ready,
+ * or cancels the call with ChannelTransport::cancel().
  */
+inline QVariantMap DeferredReply(const QString &token) {
+  return QVariantMap { { kDeferredReplyKey, token } };
+}
 
-class ChannelTransport : public QWebChannelAbstractTransport{
+/**
+ * Transport of web channel between QCef page and Qt objects.
+ * Messages sent to web page are packed into one JSON array frame per
+ * event loop pass, and frames from web page are parsed once. Slots may
+ * reply later with DeferredReply(), and web page may cancel such calls.
+ * Traffic of each method is counted, see dumpStats().
+ */
+class ChannelTransport : public QWebChannelAbstractTransport {
   Q_OBJECT
-  public:
-    ChannelTransport(QObject *parent): QWebChannelAbstractTransport(parent) {
-    }
-    signals:
-      void sendMessageString(const QString &msg);
-    public slots:
-      void sendMessage(const QJsonObject &msg){
-        QJsonDocument doc(msg);
-        emit this->sendMessageString(doc.toJson());
-      }
+ public:
+  explicit ChannelTransport(QObject* parent);
+
+  /**
+   * Objects registered to web channel, used to name methods and signals
+   * in dumpStats(). Set it before web page is loaded.
+   */
+  void setObjects(const QHash<QString, QObject*>& objects) {
+    objects_ = objects;
+  }
+
+  /**
+   * Returns table of messages, bytes and round trip time of each method
+   * and signal of web channel objects, since transport is created.
+   */
+  QString dumpStats();
+
+  /**
+   * Count message received from web page, |bytes| is its share of the
+   * frame. Method calls are timed until they are replied.
+   */
+  void recordReceived(const QJsonObject& msg, int bytes);
+
+  // Count a frame of messages received from web page.
+  void recordFrameReceived(int bytes);
+
+  // Track method call |msg| until its slot returns, so that it can be
+  // cancelled meanwhile.
+  void callReceived(const QJsonObject& msg);
+
+ signals:
+  void sendMessageString(const QString& msg);
+
+  /**
+   * Emitted when web page cancels deferred call |token|, owner of the
+   * call shall stop it and drop its result.
+   */
+  void requestCancelled(const QString& token);
+
+ public slots:
+  void sendMessage(const QJsonObject& msg) override;
+
+  /**
+   * Cancel call |id| sent by web page. Web page is replied with
+   * kCancelledReply at once if it is a deferred call.
+   * Might be called before the slot returns, ignored if call is
+   * already replied.
+   */
+  void cancel(int id);
+
+  /**
+   * Complete response of a deferred slot call.
+   * Might be called from any thread, even before the slot returns.
+   */
+  void reply(const QString& token, const QVariant& result);
+
+  /**
+   * Same as reply(), but result is already serialized to JSON text,
+   * which is spliced into response message as is.
+   */
+  void replyJson(const QString& token, const QByteArray& json);
+
+ private:
+  void holdResponse(int id, const QString& token, const QJsonObject& msg);
+
+  // Write response header with QJsonDocument and append |json| as data,
+  // result is never converted to QJsonValue.
+  void sendResponse(QJsonObject msg, const QByteArray& json);
+
+  // Count message sent to web page, and finish timing of its call.
+  void recordSent(const QJsonObject& msg, int bytes);
+
+  /**
+   * Messages are packed into one JSON array frame, which is sent once
+   * control returns to event loop of transport thread. A burst of
+   * signals and property updates costs one hop to web page.
+   */
+  void appendFrame(const QByteArray& msg);
+
+  void flushFrame();
+
+  QMutex frame_mutex_;
+  QByteArray frame_;
+  bool flush_pending_ = false;
+
+  QMutex deferred_mutex_;
+  QHash<QString, QJsonObject> deferred_responses_;
+  QHash<QString, QByteArray> deferred_results_;
+  // Call id => token of deferred calls waiting for result.
+  QHash<int, QString> deferred_tokens_;
+  // Calls whose slots have not returned yet.
+  QSet<int> calling_ids_;
+  // Calls cancelled before their slots return, subset of calling_ids_.
+  QSet<int> cancelled_ids_;
+  // Results of these calls are dropped.
+  QSet<QString> cancelled_tokens_;
+
+  // Traffic of one method, signal or message type.
+  struct TrafficStats {
+    qint64 received = 0;
+    qint64 sent = 0;
+    qint64 bytes_in = 0;
+    qint64 bytes_out = 0;
+    // Round trip time of replied calls, in nanoseconds.
+    qint64 replies = 0;
+    qint64 total_ns = 0;
+    qint64 max_ns = 0;
+  };
+  struct PendingCall {
+    QString key;
+    qint64 start_ns;
+  };
+
+  QMutex stats_mutex_;
+  QElapsedTimer clock_;
+  QHash<QString, QObject*> objects_;
+  // Keyed by StatsKey().
+  QHash<QString, TrafficStats> stats_;
+  // Call id => call in flight.
+  QHash<int, PendingCall> pending_calls_;
+  qint64 frames_in_ = 0;
+  qint64 frames_out_ = 0;
+  qint64 bytes_in_ = 0;
+  qint64 bytes_out_ = 0;
 };
 
 class ChannelProxy : public QObject {
@@ -35,12 +185,14 @@ class ChannelProxy : public QObject {
  signals:
   void message(const QString &msgData);
  public slots:
-  void send(const QString &msgData){
-    auto doc = QJsonDocument::fromJson(msgData.toUtf8());
-    if( doc.isObject() ){
-      emit this->transport->messageReceived(doc.object(), this->transport);
-    }
-  }
+  /**
+   * Receive a message, or a frame of messages packed in JSON array by
+   * web page, which is parsed once.
+   */
+  void send(const QString &msgData);
+
+ private:
+  void receive(const QJsonObject &msg, int bytes);
 };
 
 }  // namespace dstore
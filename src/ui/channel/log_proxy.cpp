@@ -19,6 +19,9 @@
 
 #include <QDebug>
 
+#include "dbus/dbus_call_stats.h"
+#include "ui/channel/channel_proxy.h"
+
 namespace dstore {
 
 LogProxy::LogProxy(QObject* parent) : QObject(parent) {
@@ -29,6 +32,10 @@ LogProxy::~LogProxy() {
 
 }
 
+void LogProxy::setChannelTransport(ChannelTransport* transport) {
+  transport_ = transport;
+}
+
 void LogProxy::debug(const QString& msg) {
   qDebug() << msg;
 }
@@ -41,4 +48,14 @@ void LogProxy::error(const QString& msg) {
   qCritical() << msg;
 }
 
+QString LogProxy::dumpStats() {
+  QString stats;
+  if (transport_ != nullptr) {
+    stats = "web channel stats:\n" + transport_->dumpStats() + "\n";
+  }
+  stats += "dbus call stats:\n" + DumpDBusCallStats();
+  qDebug().noquote() << stats;
+  return stats;
+}
+
 }  // namespace dstore
\ No newline at end of file
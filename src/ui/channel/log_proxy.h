@@ -22,6 +22,8 @@
 
 namespace dstore {
 
+class ChannelTransport;
+
 /**
  * This proxy object is used by web page to write log messages to local
  * log file.
@@ -32,10 +34,20 @@ class LogProxy : public QObject {
   explicit LogProxy(QObject* parent = nullptr);
   ~LogProxy() override;
 
+  // Traffic of |transport| is reported in dumpStats().
+  void setChannelTransport(ChannelTransport* transport);
+
  public slots:
   void debug(const QString& msg);
   void warn(const QString& msg);
   void error(const QString& msg);
+
+  // Returns web channel traffic and dbus call stats, and also writes them
+  // to log file.
+  QString dumpStats();
+
+ private:
+  ChannelTransport* transport_ = nullptr;
 };
 
 }  // namespace dstore
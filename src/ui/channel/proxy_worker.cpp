@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ui/channel/proxy_worker.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include "base/json_writer.h"
+#include "ui/channel/channel_proxy.h"
+
+namespace dstore {
+
+namespace {
+
+// DBus daemon serves requests one by one, a few bulk requests in flight
+// keep it busy without delaying interactive ones.
+const int kInteractiveConcurrency = 8;
+const int kBackgroundConcurrency = 2;
+
+}  // namespace
+
+ProxyWorker::ProxyWorker(const QString& name, QObject* parent)
+    : QObject(parent),
+      thread_(new QThread(this)),
+      context_(new QObject()) {
+  this->setObjectName(name);
+  thread_->setObjectName(name);
+  running_[Interactive] = 0;
+  running_[Background] = 0;
+  limits_[Interactive] = kInteractiveConcurrency;
+  limits_[Background] = kBackgroundConcurrency;
+  this->adopt(context_);
+  thread_->start();
+}
+
+ProxyWorker::~ProxyWorker() {
+  thread_->quit();
+  thread_->wait();
+}
+
+void ProxyWorker::adopt(QObject* object) {
+  object->moveToThread(thread_);
+  connect(thread_, &QThread::finished, object, &QObject::deleteLater);
+}
+
+void ProxyWorker::setConcurrency(Priority priority, int limit) {
+  {
+    QMutexLocker locker(&mutex_);
+    limits_[priority] = qMax(1, limit);
+  }
+  this->post([this]() {
+    this->schedule();
+  });
+}
+
+QVariantMap ProxyWorker::defer(Request request, Priority priority) {
+  return this->deferCancellable([request](Reply reply, CancelCheck) {
+    request(reply);
+  }, priority);
+}
+
+QVariantMap ProxyWorker::deferCancellable(CancellableRequest request,
+                                          Priority priority) {
+  const QString token = NewDeferredReplyToken();
+  {
+    QMutexLocker locker(&mutex_);
+    pending_.insert(token);
+    queues_[priority].enqueue(Task { token, request });
+  }
+  this->post([this]() {
+    this->schedule();
+  });
+  return DeferredReply(token);
+}
+
+void ProxyWorker::schedule() {
+  for (int priority = Interactive; priority < kPriorityCount; ++priority) {
+    while (true) {
+      Task task;
+      {
+        QMutexLocker locker(&mutex_);
+        if (queues_[priority].isEmpty() ||
+            running_[priority] >= limits_[priority]) {
+          break;
+        }
+        task = queues_[priority].dequeue();
+        // Cancelled before it is started.
+        if (cancelled_.remove(task.token)) {
+          pending_.remove(task.token);
+          continue;
+        }
+        running_[priority]++;
+      }
+
+      const QString token = task.token;
+      const CancelCheck cancelled = [this, token]() {
+        return this->isCancelled(token);
+      };
+      task.request([=](const QVariant& result) {
+        {
+          QMutexLocker locker(&mutex_);
+          running_[priority]--;
+        }
+        if (this->finish(token)) {
+          emit this->replyReady(token, ToCompactJson(result));
+        }
+        // Reply might be called in another thread, or inside schedule().
+        this->post([this]() {
+          this->schedule();
+        });
+      }, cancelled);
+    }
+  }
+}
+
+void ProxyWorker::cancel(const QString& token) {
+  QMutexLocker locker(&mutex_);
+  if (pending_.contains(token)) {
+    cancelled_.insert(token);
+  }
+}
+
+bool ProxyWorker::isCancelled(const QString& token) {
+  QMutexLocker locker(&mutex_);
+  return cancelled_.contains(token);
+}
+
+bool ProxyWorker::finish(const QString& token) {
+  QMutexLocker locker(&mutex_);
+  pending_.remove(token);
+  return !cancelled_.remove(token);
+}
+
+void ProxyWorker::post(std::function<void()> task) {
+  QMetaObject::invokeMethod(context_, task, Qt::QueuedConnection);
+}
+
+}  // namespace dstore
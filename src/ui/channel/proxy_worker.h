@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2018 Deepin Technology Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEEPIN_APPSTORE_UI_CHANNEL_PROXY_WORKER_H
+#define DEEPIN_APPSTORE_UI_CHANNEL_PROXY_WORKER_H
+
+#include <functional>
+
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QVariantMap>
+
+class QThread;
+
+namespace dstore {
+
+/**
+ * Worker thread of a proxy object.
+ * Web channel thread only dispatches messages, blocking calls of a proxy
+ * run in its own worker, so that a slow package request does not stall
+ * search or settings.
+ *
+ * Deferred requests are scheduled by priority, interactive requests are
+ * always started before queued background ones, and each class has its
+ * own limit of requests in flight.
+ */
+class ProxyWorker : public QObject {
+  Q_OBJECT
+ public:
+  // |name| is used as name of worker thread.
+  explicit ProxyWorker(const QString& name, QObject* parent = nullptr);
+  ~ProxyWorker() override;
+
+  // Delivers result of a deferred request, might be called from any thread.
+  typedef std::function<void(const QVariant& result)> Reply;
+  typedef std::function<void(Reply reply)> Request;
+  // Tells a running request whether it is cancelled, thread safe.
+  typedef std::function<bool()> CancelCheck;
+  typedef std::function<void(Reply reply, CancelCheck cancelled)>
+      CancellableRequest;
+
+  enum Priority {
+    // Waited by user, e.g. settings, job control and opening an app.
+    Interactive = 0,
+    // Bulk requests, e.g. installed package list and download sizes.
+    Background = 1,
+  };
+
+  /**
+   * Set max number of |priority| requests in flight, at least 1.
+   * A request is in flight from it is started until it is replied.
+   */
+  void setConcurrency(Priority priority, int limit);
+
+  /**
+   * Move |object| into worker thread, it is deleted when worker stops.
+   */
+  void adopt(QObject* object);
+
+  /**
+   * Run |request| in worker thread and return a deferred reply marker
+   * at once, result is emitted by replyReady().
+   */
+  QVariantMap defer(Request request, Priority priority = Interactive);
+
+  /**
+   * Same as defer(), but |request| also receives a check of its
+   * cancellation, so that a long request can stop early. It must still
+   * reply, the result is dropped.
+   */
+  QVariantMap deferCancellable(CancellableRequest request,
+                               Priority priority = Interactive);
+
+  /**
+   * Run |task| in worker thread, for calls without result.
+   */
+  void post(std::function<void()> task);
+
+  /**
+   * Cancel deferred request |token| if it is started by this worker.
+   * It is skipped if not yet run, and its result is dropped otherwise.
+   * Might be called from any thread.
+   */
+  void cancel(const QString& token);
+
+  // Check whether request |token| is cancelled.
+  bool isCancelled(const QString& token);
+
+ signals:
+  /**
+   * Emitted in worker thread when result of a deferred request is ready.
+   * @param token returned by DeferredReply()
+   * @param json result serialized in compact JSON
+   */
+  void replyReady(const QString& token, const QByteArray& json);
+
+ private:
+  // Remove |token| from pending requests, returns false if it is cancelled.
+  bool finish(const QString& token);
+
+  // Start queued requests allowed by concurrency limits, in worker thread.
+  void schedule();
+
+  struct Task {
+    QString token;
+    CancellableRequest request;
+  };
+
+  QThread* thread_ = nullptr;
+  // Lives in worker thread, context of queued tasks.
+  QObject* context_ = nullptr;
+
+  QMutex mutex_;
+  QSet<QString> pending_;
+  QSet<QString> cancelled_;
+
+  static const int kPriorityCount = 2;
+  QQueue<Task> queues_[kPriorityCount];
+  int running_[kPriorityCount];
+  int limits_[kPriorityCount];
+};
+
+}  // namespace dstore
+
+#endif  // DEEPIN_APPSTORE_UI_CHANNEL_PROXY_WORKER_H
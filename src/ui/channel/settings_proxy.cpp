@@ -20,16 +20,15 @@
 #include "ui/channel/settings_proxy.h"
 
 #include "services/settings_manager.h"
+#include "ui/channel/proxy_worker.h"
 
 namespace dstore
 {
 
-SettingsProxy::SettingsProxy(QObject *parent) : QObject(parent)
+namespace
 {
-    this->setObjectName("SettingsProxy");
-}
 
-const QVariantMap SettingsProxy::getSettings()
+QVariantMap ReadSettings()
 {
     return QVariantMap {
         // user settings
@@ -52,10 +51,36 @@ const QVariantMap SettingsProxy::getSettings()
     };
 }
 
+}  // namespace
+
+SettingsProxy::SettingsProxy(QObject *parent)
+    : QObject(parent),
+      worker_(new ProxyWorker("SettingsWorker", this))
+{
+    this->setObjectName("SettingsProxy");
+    connect(worker_, &ProxyWorker::replyReady,
+            this, &SettingsProxy::deferredReplyReady,
+            Qt::DirectConnection);
+}
+
+void SettingsProxy::cancelRequest(const QString &token)
+{
+    worker_->cancel(token);
+}
+
+QVariantMap SettingsProxy::getSettings()
+{
+    return worker_->defer([](ProxyWorker::Reply reply) {
+        reply(ReadSettings());
+    });
+}
+
 
 void SettingsProxy::setAutoInstall(bool autoInstall)
 {
-    SettingsManager::instance()->setAutoInstall(autoInstall);
+    worker_->post([autoInstall]() {
+        SettingsManager::instance()->setAutoInstall(autoInstall);
+    });
 }
 
 void SettingsProxy::openUrl(const QString &url)
@@ -24,6 +24,8 @@
 namespace dstore
 {
 
+class ProxyWorker;
+
 /**
  * Expose backend settings to web page.
  */
@@ -33,16 +35,29 @@ class SettingsProxy : public QObject
 public:
     explicit SettingsProxy(QObject *parent = nullptr);
 
+    /**
+     * Stop deferred call |token| cancelled by web page, thread safe.
+     */
+    void cancelRequest(const QString &token);
+
 Q_SIGNALS:
     void raiseWindowRequested();
     void fontChangeRequested(const QString &fontFamily, int pixelSize);
 
+    /**
+     * Emitted when result of a deferred call is ready.
+     * @param token returned by DeferredReply()
+     * @param json result serialized in compact JSON
+     */
+    void deferredReplyReady(const QString &token, const QByteArray &json);
+
 public Q_SLOTS:
     /**
      * Returns metadata server and operation server address.
+     * Settings are read from backend daemon in settings worker.
      * @return
      */
-    const QVariantMap getSettings();
+    QVariantMap getSettings();
 
     /**
      * Allow auto install software
@@ -60,6 +75,10 @@ public Q_SLOTS:
      * Raise main window.
      */
     void raiseWindow();
+
+private:
+    // Settings are read and written over DBus in this worker.
+    ProxyWorker *worker_ = nullptr;
 };
 
 }  // namespace dstore
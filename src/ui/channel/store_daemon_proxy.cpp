@@ -28,7 +28,7 @@ namespace dstore
 
 StoreDaemonProxy::StoreDaemonProxy(QObject *parent)
     : QObject(parent),
-      manager_thread_(new QThread(this)),
+      worker_(new ProxyWorker("StoreDaemonWorker", this)),
       manager_(new StoreDaemonManager())
 {
 
@@ -38,23 +38,57 @@ StoreDaemonProxy::StoreDaemonProxy(QObject *parent)
 
     this->initConnections();
 
-    manager_thread_->start();
-    manager_->moveToThread(manager_thread_);
+    worker_->adopt(manager_);
 
 }
 
 StoreDaemonProxy::~StoreDaemonProxy()
 {
-    manager_thread_->quit();
-    manager_thread_->wait(3);
+}
+
+void StoreDaemonProxy::cancelRequest(const QString &token)
+{
+    worker_->cancel(token);
 }
 
 void StoreDaemonProxy::initConnections()
 {
-    connect(manager_thread_, &QThread::finished,
-            manager_, &StoreDaemonManager::deleteLater);
+    // Results are emitted in worker thread, and queued to transport
+    // directly without passing through web channel thread.
+    connect(worker_, &ProxyWorker::replyReady,
+            this, &StoreDaemonProxy::deferredReplyReady,
+            Qt::DirectConnection);
     connect(manager_, &StoreDaemonManager::jobListChanged,
             this, &StoreDaemonProxy::jobListChanged);
+    connect(manager_, &StoreDaemonManager::jobsAdded,
+            this, &StoreDaemonProxy::jobsAdded);
+    connect(manager_, &StoreDaemonManager::jobsRemoved,
+            this, &StoreDaemonProxy::jobsRemoved);
+    connect(manager_, &StoreDaemonManager::installedPackagesChanged,
+            this, &StoreDaemonProxy::installedPackagesChanged);
+    connect(manager_, &StoreDaemonManager::jobsUpdated,
+            this, &StoreDaemonProxy::jobsUpdated);
+}
+
+QVariantMap StoreDaemonProxy::defer(DeferredRequest request,
+                                    ProxyWorker::Priority priority)
+{
+    return worker_->defer([ = ](ProxyWorker::Reply reply) {
+        request([ = ](const QVariantMap & result) {
+            reply(result);
+        });
+    }, priority);
+}
+
+QVariantMap StoreDaemonProxy::deferCancellable(CancellableRequest request,
+                                               ProxyWorker::Priority priority)
+{
+    return worker_->deferCancellable([ = ](ProxyWorker::Reply reply,
+                                           ProxyWorker::CancelCheck cancelled) {
+        request([ = ](const QVariantMap & result) {
+            reply(result);
+        }, cancelled);
+    }, priority);
 }
 
 }  // namespace dstore
@@ -18,6 +18,8 @@
 #ifndef DEEPIN_APPSTORE_UI_STORE_DAEMON_PROXY_H
 #define DEEPIN_APPSTORE_UI_STORE_DAEMON_PROXY_H
 
+#include <functional>
+
 #include <QDebug>
 #include <QObject>
 #include <QThread>
@@ -26,6 +28,7 @@
 
 #include "services/search_result.h"
 #include "services/store_daemon_manager.h"
+#include "ui/channel/proxy_worker.h"
 
 namespace dstore
 {
@@ -37,6 +40,11 @@ public:
     explicit StoreDaemonProxy(QObject *parent = nullptr);
     ~StoreDaemonProxy() override;
 
+    /**
+     * Stop deferred call |token| cancelled by web page, thread safe.
+     */
+    void cancelRequest(const QString &token);
+
 Q_SIGNALS:
     // void isDbusConnectedReply(bool state);
 
@@ -51,13 +59,44 @@ Q_SIGNALS:
     */
     void jobListChanged(const QStringList &jobs);
 
+    /**
+     * Emitted with paths of new jobs.
+     */
+    void jobsAdded(const QStringList &jobs);
+
+    /**
+     * Emitted with paths of finished jobs.
+     */
+    void jobsRemoved(const QStringList &jobs);
+
+    /**
+     * Emitted when list of installed packages is changed.
+     * @param version
+     */
+    void installedPackagesChanged(qlonglong version);
+
+    /**
+     * Emitted periodically after subscribeJobs() is called.
+     * @param jobs job path => changed fields of job info
+     */
+    void jobsUpdated(const QVariantMap &jobs);
+
+    /**
+     * Emitted when result of a deferred call is ready.
+     * @param token returned by DeferredReply()
+     * @param json result serialized in compact JSON
+     */
+    void deferredReplyReady(const QString &token, const QByteArray &json);
+
 public Q_SLOTS:
     /**
      * Check connecting to backend app store daemon or not.
      */
-    bool isDBusConnected()
+    QVariantMap isDBusConnected()
     {
-        return manager_->isDBusConnected();
+        return worker_->defer([ = ](ProxyWorker::Reply reply) {
+            reply(manager_->isDBusConnected());
+        });
     }
 
     // Store Manager methods:
@@ -67,7 +106,25 @@ public Q_SLOTS:
      */
     QVariantMap query(const QVariantList &apps)
     {
-        return manager_->query(apps);
+        return this->deferCancellable([ = ](StoreDaemonManager::ReplyCallback callback,
+                                            ProxyWorker::CancelCheck cancelled) {
+            manager_->query(apps, callback, cancelled);
+        }, ProxyWorker::Background);
+    }
+
+    /**
+     * Same as query(), but packages only carry fields in |projection|.
+     * * fields: stringList, package fields to return.
+     * * locale: string, return localName in this locale instead of
+     *   allLocalName.
+     */
+    QVariantMap queryProjected(const QVariantList &apps,
+                               const QVariantMap &projection)
+    {
+        return this->deferCancellable([ = ](StoreDaemonManager::ReplyCallback callback,
+                                            ProxyWorker::CancelCheck cancelled) {
+            manager_->query(apps, projection, callback, cancelled);
+        }, ProxyWorker::Background);
     }
 
     /**
@@ -76,7 +133,10 @@ public Q_SLOTS:
      */
     QVariantMap queryDownloadSize(const QVariantList &apps)
     {
-        return manager_->queryDownloadSize(apps);
+        return this->deferCancellable([ = ](StoreDaemonManager::ReplyCallback callback,
+                                            ProxyWorker::CancelCheck cancelled) {
+            manager_->queryDownloadSize(apps, callback, cancelled);
+        }, ProxyWorker::Background);
     }
 
     /**
@@ -84,7 +144,58 @@ public Q_SLOTS:
      */
     QVariantMap installedPackages()
     {
-        return manager_->installedPackages();
+        return this->deferCancellable([ = ](StoreDaemonManager::ReplyCallback callback,
+                                            ProxyWorker::CancelCheck cancelled) {
+            manager_->installedPackages(callback, cancelled);
+        }, ProxyWorker::Background);
+    }
+
+    /**
+     * Get a list of installed packages, trimmed to |projection|,
+     * see queryProjected().
+     */
+    QVariantMap installedPackagesProjected(const QVariantMap &projection)
+    {
+        return this->deferCancellable([ = ](StoreDaemonManager::ReplyCallback callback,
+                                            ProxyWorker::CancelCheck cancelled) {
+            manager_->installedPackages(projection, callback, cancelled);
+        }, ProxyWorker::Background);
+    }
+
+    /**
+     * Get one page of installed packages.
+     * @param page offset, limit, sort, order and projection of packages,
+     * see StoreDaemonManager::installedPackagesPage().
+     */
+    QVariantMap installedPackagesPage(const QVariantMap &page)
+    {
+        return this->deferCancellable([ = ](StoreDaemonManager::ReplyCallback callback,
+                                            ProxyWorker::CancelCheck cancelled) {
+            manager_->installedPackagesPage(page, callback, cancelled);
+        }, ProxyWorker::Background);
+    }
+
+    /**
+     * Get a list of installed packages if it is changed since |version|.
+     * @param version returned by last installedPackages() call
+     */
+    QVariantMap installedPackagesSince(qlonglong version)
+    {
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->installedPackagesSince(version, callback);
+        }, ProxyWorker::Background);
+    }
+
+    /**
+     * Get upgradable apps by comparing |catalog| with installed versions
+     * locally.
+     * @param catalog app name => remote version
+     */
+    QVariantMap upgradablePackages(const QVariantMap &catalog)
+    {
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->upgradablePackages(catalog, callback);
+        }, ProxyWorker::Background);
     }
 
     /**
@@ -93,7 +204,9 @@ public Q_SLOTS:
      */
     void openApp(const QVariant &app)
     {
-        return manager_->openApp(app);
+        worker_->post([ = ]() {
+            manager_->openApp(app);
+        });
     }
 
     /**
@@ -103,7 +216,9 @@ public Q_SLOTS:
      */
     QVariantMap installPackages(const QVariantList &apps)
     {
-        return manager_->installPackage(apps);
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->installPackage(apps, callback);
+        });
     }
 
     /**
@@ -112,7 +227,9 @@ public Q_SLOTS:
      */
     QVariantMap updatePackages(const QVariantList &apps)
     {
-        return manager_->updatePackage(apps);
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->updatePackage(apps, callback);
+        });
     }
 
     /**
@@ -121,7 +238,9 @@ public Q_SLOTS:
      */
     QVariantMap removePackages(const QVariantList &apps)
     {
-        return manager_->removePackage(apps);
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->removePackage(apps, callback);
+        });
     }
 
     /**
@@ -130,7 +249,9 @@ public Q_SLOTS:
      */
     QVariantMap jobList()
     {
-        return manager_->jobList();
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->jobList(callback);
+        });
     }
 
     /**
@@ -148,12 +269,31 @@ public Q_SLOTS:
      */
     QVariantMap getJobInfo(const QString &job)
     {
-        return manager_->getJobInfo(job);
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->getJobInfo(job, callback);
+        });
     }
 
+    /**
+     * Get info of several jobs, see getJobInfo(). Progress of jobs is
+     * watched by user, so it is not queued behind bulk queries.
+     */
     QVariantMap getJobsInfo(const QStringList &jobs)
     {
-        return manager_->getJobsInfo(jobs);
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->getJobsInfo(jobs, callback);
+        });
+    }
+
+    /**
+     * Receive changes of jobs with jobsUpdated(), at most |rate| times
+     * per second. Set |rate| to 0 to unsubscribe.
+     */
+    void subscribeJobs(int rate)
+    {
+        worker_->post([ = ]() {
+            manager_->setJobsUpdateRate(rate);
+        });
     }
 
 
@@ -163,7 +303,9 @@ public Q_SLOTS:
      */
     QVariantMap cleanJob(const QString &job)
     {
-        return manager_->cleanJob(job);
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->cleanJob(job, callback);
+        });
     }
 
     /**
@@ -172,7 +314,9 @@ public Q_SLOTS:
      */
     QVariantMap pauseJob(const QString &job)
     {
-        return manager_->pauseJob(job);
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->pauseJob(job, callback);
+        });
     }
 
     /**
@@ -181,7 +325,9 @@ public Q_SLOTS:
      */
     QVariantMap startJob(const QString &job)
     {
-        return manager_->startJob(job);
+        return this->defer([ = ](StoreDaemonManager::ReplyCallback callback) {
+            manager_->startJob(job, callback);
+        });
     }
 
     /**
@@ -189,25 +335,65 @@ public Q_SLOTS:
      */
     QVariantMap fixError(const QString &error_type)
     {
-        return manager_->fixError(error_type);
+        return worker_->defer([ = ](ProxyWorker::Reply reply) {
+            reply(manager_->fixError(error_type));
+        });
+    }
+
+    /**
+     * Echo |payload| back, measures plain round trip of web channel.
+     */
+    QVariant ping(const QVariant &payload)
+    {
+        return payload;
     }
 
-    QString test()
+    /**
+     * Echo |payload| back as deferred reply from proxy worker, measures
+     * round trip of worker dispatch.
+     */
+    QVariantMap pingDeferred(const QVariant &payload)
     {
-        QThread::sleep(3);
-        return "this is test";
+        return worker_->defer([ = ](ProxyWorker::Reply reply) {
+            reply(payload);
+        });
     }
 
     // TODO: just for search
     void updateAppList(const SearchMetaList &app_list)
     {
-        return manager_->updateAppList(app_list);
+        worker_->post([ = ]() {
+            manager_->updateAppList(app_list);
+        });
     }
 
 private:
     void initConnections();
 
-    QThread *manager_thread_ = nullptr;
+    typedef std::function<void(StoreDaemonManager::ReplyCallback)> DeferredRequest;
+
+    /**
+     * Run |request| in manager thread and return a deferred reply marker,
+     * result is serialized in manager thread and emitted by
+     * deferredReplyReady() once backend replies.
+     * Bulk requests are scheduled with Background |priority|, so that they
+     * do not delay calls waited by user.
+     */
+    QVariantMap defer(DeferredRequest request,
+                      ProxyWorker::Priority priority = ProxyWorker::Interactive);
+
+    typedef std::function<void(StoreDaemonManager::ReplyCallback,
+                               ProxyWorker::CancelCheck)> CancellableRequest;
+
+    /**
+     * Same as defer(), long |request| gets a check to stop early once web
+     * page cancels it.
+     */
+    QVariantMap deferCancellable(CancellableRequest request,
+                                 ProxyWorker::Priority priority = ProxyWorker::Interactive);
+
+    // All calls of manager run in this worker, manager lives in it.
+    ProxyWorker *worker_ = nullptr;
     StoreDaemonManager *manager_ = nullptr;
 };
 
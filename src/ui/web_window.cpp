@@ -307,6 +307,26 @@ void WebWindow::initProxy()
     web_channel->registerObject("storeDaemon", store_daemon_proxy_);
     web_channel->registerObject("account", account_proxy_);
 
+    // Name methods in traffic stats, dumped via log.dumpStats().
+    channel_proxy->transport->setObjects(web_channel->registeredObjects());
+    log_proxy_->setChannelTransport(channel_proxy->transport);
+
+    // Slow backend calls run in worker of their proxy, and are replied to
+    // web page once they are finished. Web channel thread only dispatches.
+    connect(store_daemon_proxy_, &StoreDaemonProxy::deferredReplyReady,
+            channel_proxy->transport, &ChannelTransport::replyJson);
+    connect(settings_proxy_, &SettingsProxy::deferredReplyReady,
+            channel_proxy->transport, &ChannelTransport::replyJson);
+    connect(account_proxy_, &AccountProxy::deferredReplyReady,
+            channel_proxy->transport, &ChannelTransport::replyJson);
+    // Token is unique among proxies, only its owner stops it.
+    connect(channel_proxy->transport, &ChannelTransport::requestCancelled,
+            this, [this](const QString & token) {
+        store_daemon_proxy_->cancelRequest(token);
+        settings_proxy_->cancelRequest(token);
+        account_proxy_->cancelRequest(token);
+    }, Qt::DirectConnection);
+
     if (useMultiThread) {
         proxy_thread_ = new QThread(parent);
         web_channel->moveToThread(proxy_thread_);
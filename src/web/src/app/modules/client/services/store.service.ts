@@ -5,6 +5,7 @@ import { map } from 'rxjs/operators';
 import * as _ from 'lodash';
 
 import { StoreJobInfo } from '../models/store-job-info';
+import { environment } from 'environments/environment';
 
 @Injectable({
   providedIn: 'root',
@@ -36,6 +37,23 @@ export class StoreService {
     return Channel.connect('storeDaemon.jobListChanged');
   }
 
+  jobsAdded(): Observable<string[]> {
+    return Channel.connect('storeDaemon.jobsAdded');
+  }
+
+  jobsRemoved(): Observable<string[]> {
+    return Channel.connect('storeDaemon.jobsRemoved');
+  }
+
+  // push changed fields of jobs at most rate times per second, 0 to stop.
+  subscribeJobs(rate: number): void {
+    Channel.exec('storeDaemon.subscribeJobs', rate);
+  }
+
+  jobsUpdated(): Observable<{ [job: string]: Partial<StoreJobInfo> }> {
+    return Channel.connect('storeDaemon.jobsUpdated');
+  }
+
   clearJob(job: string): void {
     Channel.exec('storeDaemon.cleanJob', job);
   }
@@ -52,25 +70,44 @@ export class StoreService {
     return Channel.exec('settings.allowShowPackageName');
   }
 
+  // only fields listed here and names in current locale are sent by client.
   InstalledPackages() {
-    interface LocalApp {
-      allLocalName: AllLocalName;
-      appName: string;
-      downloadSize: number;
-      installedTime: number;
-      localName: string;
-      localVersion: string;
-      packageName: string;
-      packageURI: string;
-      remoteVersion: string;
-      size: number;
-      upgradable: boolean;
-    }
-    interface AllLocalName {
-      en_US: string;
-      zh_CN: string;
-    }
-    return this.execWithCallback<LocalApp[]>('storeDaemon.installedPackages');
+    return this.execWithCallback<LocalApp[]>('storeDaemon.installedPackagesProjected', localAppProjection());
+  }
+
+  // one page of installed packages, newest first.
+  InstalledPackagesPage(pageIndex: number, pageSize: number) {
+    const page = {
+      ...localAppProjection(),
+      offset: pageIndex * pageSize,
+      limit: pageSize,
+      sort: 'installedTime',
+      order: 'desc',
+    };
+    // page request is cancelled in client when it is no longer wanted.
+    return new Observable<{ total: number; list: LocalApp[] }>(obs => {
+      const request = Channel.exec<StoreResponse & { total: number }>('storeDaemon.installedPackagesPage', page);
+      request.then(
+        resp => {
+          if (resp.ok) {
+            obs.next({ total: resp.total, list: resp.result as LocalApp[] });
+            obs.complete();
+          } else {
+            obs.error(resp);
+          }
+        },
+        err => obs.error(err),
+      );
+      return () => request.cancel();
+    });
+  }
+
+  // apps in catalog (name => remote version) newer than installed ones, compared by client.
+  upgradablePackages(catalog: { [name: string]: string }) {
+    return this.execWithCallback<{ appName: string; localVersion: string; remoteVersion: string }[]>(
+      'storeDaemon.upgradablePackages',
+      catalog,
+    );
   }
 
   queryDownloadSize(param: QueryParam[]) {
@@ -82,7 +119,10 @@ export class StoreService {
     );
   }
   query(opts: QueryParam[]) {
-    return this.execWithCallback<QueryResult>('storeDaemon.query', opts).pipe(
+    const projection: Projection = {
+      fields: ['appName', 'packageName', 'packageURI', 'localVersion', 'remoteVersion', 'upgradable', 'installedTime'],
+    };
+    return this.execWithCallback<QueryResult>('storeDaemon.queryProjected', opts, projection).pipe(
       map(results => {
         const arr = opts.map(opt => {
           const result = results[opt.name];
@@ -115,6 +155,30 @@ class StoreResponse {
   result: any;
 }
 
+// fields of packages returned by client, and locale of localName.
+interface Projection {
+  fields?: string[];
+  locale?: string;
+}
+
+export interface LocalApp {
+  appName: string;
+  installedTime: number;
+  localName: string;
+  localVersion: string;
+  packageName: string;
+  packageURI: string;
+  size: number;
+}
+
+// locale is resolved at call time, it is set after translations are loaded.
+function localAppProjection(): Projection {
+  return {
+    fields: ['appName', 'installedTime', 'localName', 'localVersion', 'packageName', 'packageURI', 'size'],
+    locale: environment.locale,
+  };
+}
+
 interface QueryResult {
   [key: string]: {
     name: string;
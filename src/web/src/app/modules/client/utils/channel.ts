@@ -3,6 +3,20 @@ import { environment } from 'environments/environment';
 import { Observable } from 'rxjs';
 
 const debug = !environment.production;
+const cancelKey = '__dstoreCancel';
+const cancelledKey = '__dstoreCancelled';
+
+// rejected by Channel.exec() when the call is cancelled.
+export class CancelledError extends Error {
+  constructor(method: string) {
+    super('cancelled: ' + method);
+  }
+}
+
+// result of a slot call, cancel() stops it in client if still running.
+export interface Request<T> extends Promise<T> {
+  cancel(): void;
+}
 
 export class Channel {
   static getSlot(path: string): Function {
@@ -25,18 +39,41 @@ export class Channel {
     ) as Signal;
   }
 
-  static exec<T>(method: string, ...args: any[]): Promise<T> {
+  // call slot of client, result can be cancelled before it is replied.
+  static exec<T>(method: string, ...args: any[]): Request<T> {
+    const channel = _.get(window, 'dstore.channel');
+    let id: number = null;
+    let settled = false;
+    const t = performance.now();
+    let promise = new Promise<T>((resolve, reject) => {
+      const execId = channel ? channel.execId : null;
+      Channel.getSlot(method)(...args, resp => {
+        settled = true;
+        if (resp && resp[cancelledKey]) {
+          reject(new CancelledError(method));
+        } else {
+          resolve(resp);
+        }
+      });
+      // qwebchannel.js assigns execId to the call just sent.
+      if (channel && channel.execId !== execId) {
+        id = channel.execId - 1;
+      }
+    });
     if (debug) {
-      const t = performance.now();
-      return new Promise<T>(resolve =>
-        Channel.getSlot(method)(...args, resolve),
-      ).then(resp => {
+      promise = promise.then(resp => {
         const consumes = performance.now() - t;
         console.warn('exec', method, { consumes, args, resp });
         return resp;
       });
     }
-    return new Promise<T>(resolve => Channel.getSlot(method)(...args, resolve));
+    const request = promise as Request<T>;
+    request.cancel = () => {
+      if (!settled && id !== null) {
+        channel.send({ [cancelKey]: id });
+      }
+    };
+    return request;
   }
   static connect<T>(method: string): Observable<T> {
     if (debug) {
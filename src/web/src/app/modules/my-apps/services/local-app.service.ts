@@ -1,6 +1,5 @@
 import { Injectable } from '@angular/core';
 import { switchMap, map } from 'rxjs/operators';
-import { chunk } from 'lodash';
 
 import { JobService } from 'app/services/job.service';
 import { StoreService, Package } from 'app/modules/client/services/store.service';
@@ -21,11 +20,10 @@ export class LocalAppService {
 
   list({ pageIndex = 0, pageSize = 20 }) {
     return this.jobService.jobList().pipe(
-      switchMap(() => this.storeService.InstalledPackages()),
-      switchMap(async installed => {
-        installed = installed.sort((a, b) => b.installedTime - a.installedTime);
-        let list = chunk(installed, pageSize)[pageIndex].map(pkg => {
-          const local_name = pkg.allLocalName[environment.locale] || pkg.allLocalName['en_US'] || pkg.packageName;
+      switchMap(() => this.storeService.InstalledPackagesPage(pageIndex, pageSize)),
+      switchMap(async ({ total, list: installed }) => {
+        let list = installed.map(pkg => {
+          const local_name = pkg.localName;
           return {
             name: pkg.appName,
             package: pkg,
@@ -43,7 +41,7 @@ export class LocalAppService {
           const m = new Map(softs.map(soft => [soft.name, soft]));
           list.forEach(item => (item.software = m.get(item.name)));
         } catch {}
-        return { total: installed.length, page: pageIndex, list };
+        return { total, page: pageIndex, list };
       }),
     );
   }
@@ -1,6 +1,6 @@
 import { Injectable } from '@angular/core';
-import { BehaviorSubject, Observable, Subscription, of, timer } from 'rxjs';
-import { switchMap, debounceTime } from 'rxjs/operators';
+import { BehaviorSubject, Observable, of } from 'rxjs';
+import { debounceTime } from 'rxjs/operators';
 
 import { StoreService } from 'app/modules/client/services/store.service';
 import {
@@ -18,21 +18,28 @@ import {
 export class JobService {
   private jobList$ = new BehaviorSubject<string[]>([]);
   private jobInfoList$ = new BehaviorSubject<StoreJobInfo[]>([]);
-  private interval: Subscription;
   private cache = new Map<string, StoreJobInfo>();
   constructor(private storeService: StoreService) {
     this.storeService
       .getJobList()
       .pipe(debounceTime(100))
       .subscribe(list => this.update(list));
-    this.storeService.jobListChange().subscribe(list => this.update(list));
+    // job list is kept up to date with deltas from backend
+    this.storeService.jobsAdded().subscribe(jobs => {
+      const list = this.jobList$.value.filter(job => !jobs.includes(job));
+      this.update([...list, ...jobs], jobs);
+    });
+    this.storeService.jobsRemoved().subscribe(jobs => {
+      this.update(this.jobList$.value.filter(job => !jobs.includes(job)), []);
+    });
+    // progress of jobs is pushed by backend, 10 times per second at most
+    this.storeService.jobsUpdated().subscribe(jobs => this.patch(jobs));
+    this.storeService.subscribeJobs(10);
   }
 
-  private update(list: string[]) {
+  // only info of added jobs is fetched, the others are patched by jobsUpdated
+  private update(list: string[], added: string[] = list) {
     this.jobList$.next(list);
-    if (this.interval) {
-      this.interval.unsubscribe();
-    }
     const defer = Array.from(this.cache.values())
       .filter(job => !list.includes(job.job))
       .map(job => job.job);
@@ -42,26 +49,35 @@ export class JobService {
         this.jobInfoList$.next(Array.from(this.cache.values()));
       }, 500);
     }
-    if (list.length > 0) {
-      this.interval = timer(0, 1000)
-        .pipe(switchMap(() => this.storeService.getJobsInfo(list)))
-        .subscribe(infoList => {
-          infoList = infoList.filter(job => {
-            if (job.type === StoreJobType.uninstall && job.status === StoreJobStatus.failed) {
-              return false;
-            }
-            return true;
-          });
-          infoList.forEach(job => {
-            this.cache.set(job.job, job);
-          });
-          this.jobInfoList$.next(Array.from(this.cache.values()));
-        });
+    if (added.length > 0) {
+      this.storeService.getJobsInfo(added).subscribe(infoList => {
+        infoList.filter(job => this.jobList$.value.includes(job.job)).forEach(job => this.set(job));
+        this.jobInfoList$.next(Array.from(this.cache.values()));
+      });
     } else {
       this.jobInfoList$.next(Array.from(this.cache.values()));
     }
   }
 
+  // merge changed fields into cached jobs
+  private patch(jobs: { [job: string]: Partial<StoreJobInfo> }) {
+    Object.entries(jobs).forEach(([path, fields]) => {
+      const job = this.cache.get(path);
+      if (job) {
+        this.set({ ...job, ...fields });
+      }
+    });
+    this.jobInfoList$.next(Array.from(this.cache.values()));
+  }
+
+  private set(job: StoreJobInfo) {
+    if (job.type === StoreJobType.uninstall && job.status === StoreJobStatus.failed) {
+      this.cache.delete(job.job);
+      return;
+    }
+    this.cache.set(job.job, job);
+  }
+
   jobList(): Observable<string[]> {
     return this.jobList$.asObservable();
   }
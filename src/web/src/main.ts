@@ -26,20 +26,36 @@ async function main() {
     return new QWebChannel(window['qt'].webChannelTransport, resolve);
   });
   // dstore channel
+  // messages are packed into JSON array frames in both directions,
+  // all messages of one tick cost one hop.
   const channel = await new Promise<any>(resolve => {
+    let outgoing: string[] = [];
     const t = {
-      send(msg: any) {
-        channelTransport.objects.channelProxy.send(msg);
+      send(msg: string) {
+        outgoing.push(msg);
+        if (outgoing.length === 1) {
+          Promise.resolve().then(() => {
+            const frame = '[' + outgoing.join(',') + ']';
+            outgoing = [];
+            channelTransport.objects.channelProxy.send(frame);
+          });
+        }
       },
       onmessage(msg: any) {},
     };
-    channelTransport.objects.channelProxy.message.connect(msg => {
+    const receive = (frame: string) => {
+      const data = JSON.parse(frame);
+      if (Array.isArray(data)) {
+        data.forEach(msg => t.onmessage({ data: msg }));
+      } else {
+        t.onmessage({ data });
+      }
+    };
+    channelTransport.objects.channelProxy.message.connect(frame => {
       if (!zone) {
-        t.onmessage({ data: msg });
+        receive(frame);
       } else {
-        zone.run(() => {
-          t.onmessage({ data: msg });
-        });
+        zone.run(() => receive(frame));
       }
     });
     return new QWebChannel(t, resolve);